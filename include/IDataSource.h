@@ -1,14 +1,28 @@
 #pragma once
+#include "UpdateTrace.h"
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <memory_resource>
 #include <string>
 #include <vector>
 #include <windows.h>
 
 using DataAvailableCallback = std::function<void()>;
 
+// Order in which pending topics are handed to Excel when a refresh cannot carry everything ("prio=high").
+enum class TopicPriority : std::uint8_t { High, Normal, Low };
+inline constexpr std::size_t TopicPriorityCount = 3;
+
 struct TopicParams {
-    std::string param1;
-    std::string param2;
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+
+    std::pmr::string param1;
+    std::pmr::string param2;
+    TopicPriority priority = TopicPriority::Normal;
+
+    TopicParams() = default;
+    explicit TopicParams(const allocator_type &alloc) : param1(alloc), param2(alloc) {}
 };
 
 struct TopicUpdate {
@@ -16,6 +30,9 @@ struct TopicUpdate {
     double value;
 };
 
+// Updates are appended into a caller-owned batch whose storage comes from the per-refresh arena.
+using TopicUpdateBatch = std::pmr::vector<TopicUpdate>;
+
 class IDataSource {
   public:
     virtual ~IDataSource() = default;
@@ -26,7 +43,8 @@ class IDataSource {
 
     virtual void Unsubscribe(long topicId) = 0;
 
-    virtual std::vector<TopicUpdate> GetNewData() = 0;
+    // Calls sampler.Sample(updates.size()) before appending each update and stamps the trace it returns, if any.
+    virtual void GetNewData(TopicUpdateBatch &updates, TraceSampler &sampler) = 0;
 
     [[nodiscard]] virtual bool CanHandle(const TopicParams &params) const = 0;
 
@@ -0,0 +1,199 @@
+#pragma once
+#include "UpdateTrace.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+enum class TraceStage : std::uint8_t { Wire, Parse, Enqueue, Pending, Total };
+inline constexpr std::size_t TraceStageCount = 5;
+inline constexpr std::array<const char *, TraceStageCount> TraceStageNames = {"wire", "parse", "enqueue", "pending",
+                                                                              "total"};
+
+// Log-linear (HDR-style) latency histogram: 32 sub-buckets per power of two, about 3% resolution up to ~18 minutes.
+// Recording is a single relaxed atomic increment, so any thread can record while another takes snapshots.
+class LatencyHistogram {
+  public:
+    static constexpr int SubBucketBits = 5;
+    static constexpr std::size_t SubBuckets = std::size_t{1} << SubBucketBits;
+    static constexpr int MaxExponent = 40;
+    static constexpr std::size_t BucketCount = (MaxExponent - SubBucketBits + 2) * SubBuckets;
+
+    using Counts = std::array<std::uint64_t, BucketCount>;
+
+    static std::size_t BucketIndex(std::int64_t ns) {
+        auto v = static_cast<std::uint64_t>(std::max<std::int64_t>(ns, 0));
+        if (v < SubBuckets)
+            return static_cast<std::size_t>(v);
+        auto exponent = static_cast<int>(std::bit_width(v)) - 1;
+        if (exponent > MaxExponent)
+            return BucketCount - 1;
+        auto sub = (v >> (exponent - SubBucketBits)) & (SubBuckets - 1);
+        return static_cast<std::size_t>(exponent - SubBucketBits + 1) * SubBuckets + static_cast<std::size_t>(sub);
+    }
+
+    // Midpoint of the values that map to a bucket.
+    static std::int64_t BucketValue(std::size_t index) {
+        auto block = index / SubBuckets;
+        auto sub = index % SubBuckets;
+        if (block == 0)
+            return static_cast<std::int64_t>(sub);
+        auto shift = static_cast<int>(block) - 1;
+        auto lower = (SubBuckets + sub) << shift;
+        return static_cast<std::int64_t>(lower + ((std::uint64_t{1} << shift) >> 1));
+    }
+
+    void Record(std::int64_t ns) { m_counts[BucketIndex(ns)].fetch_add(1, std::memory_order_relaxed); }
+
+    void Load(Counts &out) const {
+        for (std::size_t i = 0; i < BucketCount; ++i)
+            out[i] = m_counts[i].load(std::memory_order_relaxed);
+    }
+
+  private:
+    std::array<std::atomic<std::uint64_t>, BucketCount> m_counts{};
+};
+
+// Per-source, per-stage latency histograms fed from sampled updates at drain time. A writer thread appends
+// percentile snapshots of each interval (not cumulative) to a CSV file for offline analysis. Sampling itself is
+// done upstream by a TraceSampler.
+class LatencyTracer {
+    struct SourceStats {
+        std::string name;
+        std::array<LatencyHistogram, TraceStageCount> stages;
+        std::array<LatencyHistogram::Counts, TraceStageCount> previous{};
+    };
+
+    // Fixed once Start() runs; recording and the writer only read the vector itself
+    std::vector<std::unique_ptr<SourceStats>> m_sources;
+
+    std::ofstream m_file;
+    std::chrono::milliseconds m_interval{0};
+    std::mutex m_wakeMutex;
+    std::condition_variable_any m_wake;
+    std::jthread m_writer;
+
+    void WriteSnapshot() {
+        using namespace std::chrono;
+        auto now = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+        LatencyHistogram::Counts counts{};
+        for (auto &source : m_sources) {
+            for (std::size_t stage = 0; stage < TraceStageCount; ++stage) {
+                source->stages[stage].Load(counts);
+                auto &previous = source->previous[stage];
+                std::uint64_t total = 0;
+                for (std::size_t i = 0; i < counts.size(); ++i) {
+                    auto current = counts[i];
+                    counts[i] -= previous[i];
+                    previous[i] = current;
+                    total += counts[i];
+                }
+                if (total == 0)
+                    continue;
+
+                m_file << now << ',' << source->name << ',' << TraceStageNames[stage] << ',' << total;
+                for (auto quantile : {0.5, 0.9, 0.99, 0.999, 1.0})
+                    m_file << ',' << Percentile(counts, total, quantile) / 1000.0;
+                m_file << '\n';
+            }
+        }
+        m_file.flush();
+    }
+
+    // Value at the given quantile (0-1] of a histogram holding total samples.
+    static std::int64_t Percentile(const LatencyHistogram::Counts &counts, std::uint64_t total, double quantile) {
+        auto target = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(quantile * static_cast<double>(total)));
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < counts.size(); ++i) {
+            seen += counts[i];
+            if (seen >= target)
+                return LatencyHistogram::BucketValue(i);
+        }
+        return LatencyHistogram::BucketValue(counts.size() - 1);
+    }
+
+  public:
+    // Shortest snapshot interval; shorter requests are raised to it
+    static constexpr std::chrono::milliseconds MinInterval{100};
+
+    LatencyTracer() = default;
+    LatencyTracer(const LatencyTracer &other) = delete;
+    LatencyTracer(LatencyTracer &&other) noexcept = delete;
+    LatencyTracer &operator=(const LatencyTracer &other) = delete;
+    LatencyTracer &operator=(LatencyTracer &&other) noexcept = delete;
+
+    ~LatencyTracer() { Stop(); }
+
+    // Sources must be added before Start(); returns the index passed to Record().
+    std::size_t AddSource(std::string name) {
+        auto stats = std::make_unique<SourceStats>();
+        stats->name = std::move(name);
+        m_sources.push_back(std::move(stats));
+        return m_sources.size() - 1;
+    }
+
+    // Writes a snapshot every interval (at least MinInterval).
+    bool Start(std::chrono::milliseconds interval, const std::string &path) {
+        if (m_writer.joinable())
+            return false;
+        m_file.open(path, std::ios::out | std::ios::app);
+        if (!m_file.is_open())
+            return false;
+        m_file << "time_ms,source,stage,count,p50_us,p90_us,p99_us,p999_us,max_us\n";
+
+        m_interval = std::max(interval, MinInterval);
+        m_writer = std::jthread([this](std::stop_token stop) {
+            std::unique_lock lock(m_wakeMutex);
+            while (!stop.stop_requested()) {
+                m_wake.wait_for(lock, stop, m_interval, [] { return false; });
+                WriteSnapshot();
+            }
+        });
+        return true;
+    }
+
+    // Writes a snapshot of the current interval now; the writer keeps its own schedule.
+    void Flush() {
+        if (!m_writer.joinable())
+            return;
+        std::lock_guard lock(m_wakeMutex);
+        WriteSnapshot();
+    }
+
+    // Writes a final snapshot and stops the writer.
+    void Stop() {
+        if (m_writer.joinable()) {
+            m_writer.request_stop();
+            m_writer.join();
+        }
+        if (m_file.is_open())
+            m_file.close();
+    }
+
+    void Record(std::size_t source, const UpdateTrace &trace, std::int64_t drainNs) {
+        if (source >= m_sources.size())
+            return;
+        auto &stages = m_sources[source]->stages;
+        auto record = [&](TraceStage stage, std::int64_t from, std::int64_t to) {
+            if (from != 0 && to != 0)
+                stages[static_cast<std::size_t>(stage)].Record(to - from);
+        };
+        record(TraceStage::Wire, trace.sourceNs, trace.receiveNs);
+        record(TraceStage::Parse, trace.receiveNs, trace.parseNs);
+        record(TraceStage::Enqueue, trace.parseNs, trace.enqueueNs);
+        record(TraceStage::Pending, trace.enqueueNs, drainNs);
+        record(TraceStage::Total, trace.sourceNs != 0 ? trace.sourceNs : trace.receiveNs, drainNs);
+    }
+};
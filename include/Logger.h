@@ -7,6 +7,7 @@
 #include <shlobj.h>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <windows.h>
 
 class Logger {
@@ -73,14 +74,10 @@ class Logger {
         if (!EnsureLogDirectory())
             return;
 
-        auto homeDir = GetUserHomeDirectory();
-        if (homeDir.empty())
+        m_logFilePath = MakeLogFilePath("RTD", ".log");
+        if (m_logFilePath.empty())
             return;
 
-        auto logDir = homeDir + "\\RTDLogs";
-        auto fileName = std::string("RTD_") + GetFileTimestamp() + ".log";
-        m_logFilePath = logDir + "\\" + fileName;
-
         m_logFile.open(m_logFilePath, std::ios::out | std::ios::app);
         if (m_logFile.is_open()) {
             m_enabled = true;
@@ -93,6 +90,14 @@ class Logger {
     Logger &operator=(const Logger &other) = delete;
     Logger &operator=(Logger &&other) noexcept = delete;
 
+    // Path of a new timestamped file in the RTDLogs directory, e.g. RTD_latency_20250101_093000.csv
+    static std::string MakeLogFilePath(const std::string &prefix, const std::string &extension) {
+        auto homeDir = GetUserHomeDirectory();
+        if (homeDir.empty())
+            return {};
+        return homeDir + "\\RTDLogs\\" + prefix + "_" + GetFileTimestamp() + extension;
+    }
+
     ~Logger() {
         if (m_logFile.is_open()) {
             m_logFile.close();
@@ -121,15 +126,17 @@ class Logger {
         m_logFile.flush();
     }
 
-    void LogSubscription(long topicId, const std::string &url, const std::string &topic) {
+    void LogSubscription(long topicId, std::string_view url, std::string_view topic) {
         if (!m_enabled)
             return;
 
         auto message = std::string{};
         if (url.starts_with("ws://") || url.starts_with("wss://")) {
-            message = "SUBSCRIBE: TopicID=" + std::to_string(topicId) + ", URL='" + url + "', Topic='" + topic + "'";
+            message = "SUBSCRIBE: TopicID=" + std::to_string(topicId) + ", URL='" + std::string(url) + "', Topic='" +
+                      std::string(topic) + "'";
         } else {
-            message = "SUBSCRIBE: TopicID=" + std::to_string(topicId) + ", Mode=LEGACY, Param='" + url + "'";
+            message =
+                "SUBSCRIBE: TopicID=" + std::to_string(topicId) + ", Mode=LEGACY, Param='" + std::string(url) + "'";
         }
         LogInfo(message);
     }
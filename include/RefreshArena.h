@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+// Monotonic arena backing a single RefreshData cycle. Everything allocated from it is dropped at once by Reset().
+// The backing buffer grows to the observed high-water mark, so once the topic set is stable a refresh cycle never
+// reaches the global heap.
+class RefreshArena {
+    // Upstream of the monotonic resource; records how much a cycle spilled past the backing buffer.
+    class OverflowResource : public std::pmr::memory_resource {
+        std::size_t m_bytes = 0;
+
+      public:
+        [[nodiscard]] std::size_t Bytes() const { return m_bytes; }
+        void Clear() { m_bytes = 0; }
+
+      private:
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+            m_bytes += bytes;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    OverflowResource m_overflow;
+    std::size_t m_capacity;
+    std::unique_ptr<std::byte[]> m_buffer;
+    std::optional<std::pmr::monotonic_buffer_resource> m_arena;
+
+  public:
+    static constexpr std::size_t DefaultCapacity = 64 * 1024;
+
+    explicit RefreshArena(std::size_t capacity = DefaultCapacity)
+        : m_capacity(capacity), m_buffer(std::make_unique_for_overwrite<std::byte[]>(capacity)) {
+        m_arena.emplace(m_buffer.get(), m_capacity, &m_overflow);
+    }
+
+    RefreshArena(const RefreshArena &other) = delete;
+    RefreshArena(RefreshArena &&other) noexcept = delete;
+    RefreshArena &operator=(const RefreshArena &other) = delete;
+    RefreshArena &operator=(RefreshArena &&other) noexcept = delete;
+
+    ~RefreshArena() = default;
+
+    [[nodiscard]] std::pmr::memory_resource *Resource() { return &*m_arena; }
+
+    [[nodiscard]] std::size_t Capacity() const { return m_capacity; }
+
+    // Drops every allocation made since the last reset. If the cycle spilled, the backing buffer is enlarged so the
+    // next cycle of the same size fits without spilling.
+    void Reset() {
+        m_arena->release();
+        if (auto spilled = m_overflow.Bytes(); spilled > 0) {
+            m_arena.reset();
+            m_capacity += spilled;
+            m_buffer = std::make_unique_for_overwrite<std::byte[]>(m_capacity);
+            m_arena.emplace(m_buffer.get(), m_capacity, &m_overflow);
+            m_overflow.Clear();
+        }
+    }
+};
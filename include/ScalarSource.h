@@ -11,7 +11,7 @@ class ScalarSource : public IDataSource {
     void Initialize(DataAvailableCallback callback) override;
     bool Subscribe(long topicId, const TopicParams &params, double &initialValue) override;
     void Unsubscribe(long topicId) override;
-    std::vector<TopicUpdate> GetNewData() override;
+    void GetNewData(TopicUpdateBatch &updates, TraceSampler &sampler) override;
     [[nodiscard]] bool CanHandle(const TopicParams &params) const override;
     void Shutdown() override;
     [[nodiscard]] std::string GetSourceName() const override;
@@ -0,0 +1,82 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+enum class PriceModel : std::uint8_t { Uniform, RandomWalk, Geometric };
+
+// Per-topic generator settings, parsed from "model=gbm;start=100;drift=0;vol=0.01;tick=0.01".
+// drift and vol are per tick: absolute price units for the random walk, fractions of price for the geometric model.
+// vol defaults to 0.1 for the random walk and 0.001 for the geometric model. Uniform reproduces the legacy noise
+// in [0, 100).
+struct PriceModelParams {
+    PriceModel model = PriceModel::Uniform;
+    double start = 100.0;
+    double drift = 0.0;
+    double vol = 0.0;
+    double tick = 0.0;
+};
+
+// A topic string is a model spec only when it contains '='; anything else (e.g. "A1") is a plain tag.
+bool IsPriceModelSpec(std::string_view param);
+
+// Returns false on an unknown key, a malformed or non-finite value, or a negative start, vol or tick. An empty spec
+// selects the uniform model.
+bool ParsePriceModelParams(std::string_view spec, PriceModelParams &params);
+
+// Synthetic prices for a dense set of slots, stored as structure-of-arrays so a whole tick is one pass.
+// Random numbers are counter-based (a hash of seed, step and slot), so slots are generated independently and in
+// any order; the AVX2 path draws eight slots at a time and the scalar fallback produces the same values.
+// Shocks are Irwin-Hall approximations of a standard normal (sum of four uniforms), which avoids log/sin on
+// the vector path. Both random models advance by an Euler step: p += s * (drift + vol * z), where s is the price
+// for the geometric model and 1 for the random walk. Published prices are rounded to the tick size.
+class SyntheticMarket {
+  public:
+    explicit SyntheticMarket(std::uint64_t seed,
+                             std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+    [[nodiscard]] std::size_t Size() const { return m_price.size(); }
+
+    [[nodiscard]] const double *Prices() const { return m_price.data(); }
+
+    [[nodiscard]] double Price(std::size_t slot) const { return m_price[slot]; }
+
+    // Appends a slot and returns its index.
+    std::size_t Add(const PriceModelParams &params);
+
+    // Removes a slot by moving the last slot into its place.
+    void Remove(std::size_t slot);
+
+    void Clear();
+
+    // Advances every slot by one tick.
+    void Step();
+
+    [[nodiscard]] bool Vectorized() const { return m_vectorized; }
+
+    // Selects the AVX2 path when the CPU supports it; false forces the scalar fallback.
+    void SetVectorized(bool enable);
+
+    [[nodiscard]] static bool CpuHasAvx2();
+
+  private:
+    std::uint64_t m_seed;
+    std::uint64_t m_step = 0;
+    bool m_vectorized;
+
+    // Structure-of-arrays state, one entry per slot
+    std::pmr::vector<double> m_state;     // unrounded model price
+    std::pmr::vector<double> m_price;     // published price
+    std::pmr::vector<double> m_drift;     // per-tick drift
+    std::pmr::vector<double> m_vol;       // per-tick volatility
+    std::pmr::vector<double> m_geometric; // 1 for the geometric model, 0 otherwise
+    std::pmr::vector<double> m_uniform;   // 1 for the uniform model, 0 otherwise
+    std::pmr::vector<double> m_tick;      // tick size, 0 for none
+    std::pmr::vector<double> m_invTick;   // 1 / tick size, 0 for none
+
+    [[nodiscard]] std::uint32_t StepKey() const;
+    void StepScalar(std::size_t begin, std::size_t end, std::uint32_t key);
+    void StepAvx2(std::size_t begin, std::size_t end, std::uint32_t key);
+};
@@ -0,0 +1,208 @@
+#pragma once
+#include "IDataSource.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Holds the latest pending value of every topic and decides which of them go out in the next RefreshData.
+// Each refresh returns at most MaxUpdatesPerRefresh values: high-priority topics drain first, low-priority ones
+// last. A topic that has waited AgingCycles refreshes in its class is promoted one class up, so sustained
+// high-priority traffic cannot starve the rest. Newer values of a still-pending topic replace the older one.
+class UpdateScheduler {
+    struct PendingEntry {
+        long topicId;
+        std::uint64_t sequence;
+        std::uint64_t enqueuedCycle;
+    };
+
+    // FIFO of pending entries backed by a ring buffer; only grows, so steady-state use never allocates.
+    class PendingQueue {
+        std::pmr::vector<PendingEntry> m_ring;
+        std::size_t m_head = 0;
+        std::size_t m_size = 0;
+
+        void Grow() {
+            auto grown = std::pmr::vector<PendingEntry>(std::max<std::size_t>(16, m_ring.size() * 2),
+                                                        m_ring.get_allocator());
+            for (std::size_t i = 0; i < m_size; ++i)
+                grown[i] = m_ring[(m_head + i) % m_ring.size()];
+            m_ring = std::move(grown);
+            m_head = 0;
+        }
+
+      public:
+        explicit PendingQueue(std::pmr::memory_resource *resource) : m_ring(resource) {}
+
+        [[nodiscard]] bool Empty() const { return m_size == 0; }
+        [[nodiscard]] const PendingEntry &Front() const { return m_ring[m_head]; }
+
+        void Push(const PendingEntry &entry) {
+            if (m_size == m_ring.size())
+                Grow();
+            m_ring[(m_head + m_size) % m_ring.size()] = entry;
+            ++m_size;
+        }
+
+        void Pop() {
+            m_head = (m_head + 1) % m_ring.size();
+            --m_size;
+        }
+
+        void Clear() {
+            m_head = 0;
+            m_size = 0;
+        }
+    };
+
+    // sequence identifies the queue entry of the pending value; entries left behind by a removed topic never match.
+    // trace holds the stamps of the pending value when it was sampled (traced)
+    struct TopicState {
+        TopicPriority priority = TopicPriority::Normal;
+        bool pending = false;
+        bool traced = false;
+        double value = 0.0;
+        std::uint64_t sequence = 0;
+        UpdateTrace trace{};
+    };
+
+    std::pmr::unsynchronized_pool_resource m_pool;
+    std::pmr::unordered_map<long, TopicState> m_topics{&m_pool};
+    std::array<PendingQueue, TopicPriorityCount> m_queues{PendingQueue(&m_pool), PendingQueue(&m_pool),
+                                                          PendingQueue(&m_pool)};
+    std::size_t m_pendingCount = 0;
+    std::size_t m_maxUpdatesPerRefresh = 0;
+    std::uint64_t m_agingCycles = 0;
+    std::uint64_t m_cycle = 0;
+    std::uint64_t m_nextSequence = 0;
+
+    PendingQueue &QueueFor(TopicPriority priority) { return m_queues[static_cast<std::size_t>(priority)]; }
+
+    // Moves entries that waited too long in a class into the next class up, resetting their wait.
+    void Age() {
+        if (m_agingCycles == 0)
+            return;
+        for (std::size_t cls = 1; cls < TopicPriorityCount; ++cls) {
+            auto &queue = m_queues[cls];
+            auto &higher = m_queues[cls - 1];
+            while (!queue.Empty() && m_cycle - queue.Front().enqueuedCycle >= m_agingCycles) {
+                higher.Push(PendingEntry{
+                    .topicId = queue.Front().topicId, .sequence = queue.Front().sequence, .enqueuedCycle = m_cycle});
+                queue.Pop();
+            }
+        }
+    }
+
+  public:
+    static constexpr std::size_t DefaultMaxUpdatesPerRefresh = 5000;
+    static constexpr std::uint64_t DefaultAgingCycles = 4;
+
+    explicit UpdateScheduler(std::size_t maxUpdatesPerRefresh = DefaultMaxUpdatesPerRefresh,
+                             std::uint64_t agingCycles = DefaultAgingCycles)
+        : m_maxUpdatesPerRefresh(maxUpdatesPerRefresh), m_agingCycles(agingCycles) {}
+
+    UpdateScheduler(const UpdateScheduler &other) = delete;
+    UpdateScheduler(UpdateScheduler &&other) noexcept = delete;
+    UpdateScheduler &operator=(const UpdateScheduler &other) = delete;
+    UpdateScheduler &operator=(UpdateScheduler &&other) noexcept = delete;
+
+    ~UpdateScheduler() = default;
+
+    // A cap of zero means unbounded; an aging period of zero disables promotion.
+    void Configure(std::size_t maxUpdatesPerRefresh, std::uint64_t agingCycles) {
+        m_maxUpdatesPerRefresh = maxUpdatesPerRefresh;
+        m_agingCycles = agingCycles;
+    }
+
+    [[nodiscard]] bool HasPending() const { return m_pendingCount != 0; }
+
+    [[nodiscard]] std::size_t PendingCount() const { return m_pendingCount; }
+
+    // Adding a topic that is already known replaces it, dropping its pending value.
+    void AddTopic(long topicId, TopicPriority priority) {
+        RemoveTopic(topicId);
+        m_topics.emplace(topicId, TopicState{.priority = priority});
+    }
+
+    // Stale queue entries of a removed topic are skipped when they reach the front, even if the id is added again.
+    void RemoveTopic(long topicId) {
+        auto it = m_topics.find(topicId);
+        if (it == m_topics.end())
+            return;
+        if (it->second.pending)
+            --m_pendingCount;
+        m_topics.erase(it);
+    }
+
+    void Clear() {
+        m_topics.clear();
+        for (auto &queue : m_queues)
+            queue.Clear();
+        m_pendingCount = 0;
+    }
+
+    // samples are the sampled stamps of updates, ordered by batch position.
+    void Post(const TopicUpdateBatch &updates, std::span<const SampledTrace> samples = {}) {
+        auto sample = samples.begin();
+        for (std::size_t i = 0; i < updates.size(); ++i) {
+            const auto &update = updates[i];
+            const UpdateTrace *trace = nullptr;
+            if (sample != samples.end() && sample->index == i) {
+                trace = &sample->trace;
+                ++sample;
+            }
+
+            auto it = m_topics.find(update.topicId);
+            if (it == m_topics.end())
+                continue;
+            auto &state = it->second;
+            state.value = update.value;
+            state.traced = trace != nullptr;
+            if (trace)
+                state.trace = *trace;
+            if (!state.pending) {
+                state.pending = true;
+                state.sequence = ++m_nextSequence;
+                ++m_pendingCount;
+                QueueFor(state.priority).Push(PendingEntry{
+                    .topicId = update.topicId, .sequence = state.sequence, .enqueuedCycle = m_cycle});
+            }
+        }
+    }
+
+    // Appends the next batch of pending values to out, highest class first, and the stamps of drained sampled
+    // values to traces (indexed by position in out).
+    void Drain(TopicUpdateBatch &out, SampledTraceBatch *traces = nullptr) {
+        ++m_cycle;
+        Age();
+
+        auto limit = m_maxUpdatesPerRefresh == 0 ? std::numeric_limits<std::size_t>::max() : m_maxUpdatesPerRefresh;
+        limit = std::min(limit, m_pendingCount);
+        out.reserve(out.size() + limit);
+
+        std::size_t drained = 0;
+        for (auto &queue : m_queues) {
+            while (drained < limit && !queue.Empty()) {
+                auto entry = queue.Front();
+                queue.Pop();
+                auto it = m_topics.find(entry.topicId);
+                if (it == m_topics.end() || !it->second.pending || it->second.sequence != entry.sequence)
+                    continue;
+                auto &state = it->second;
+                state.pending = false;
+                --m_pendingCount;
+                if (traces && state.traced)
+                    traces->push_back(SampledTrace{.index = out.size(), .trace = state.trace});
+                state.traced = false;
+                out.push_back(TopicUpdate{.topicId = entry.topicId, .value = state.value});
+                ++drained;
+            }
+        }
+    }
+};
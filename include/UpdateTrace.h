@@ -0,0 +1,71 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+// Monotonic nanoseconds; every trace stamp is in this domain.
+inline std::int64_t TraceNow() {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Converts a feed "ts" field (Unix epoch in s, ms, us or ns, told apart by magnitude) into the TraceNow() domain,
+// using the wall-clock offset observed at receiveNs.
+inline std::int64_t FeedTimestampToTrace(std::int64_t ts, std::int64_t receiveNs) {
+    using namespace std::chrono;
+    auto epochNs = ts < 100'000'000'000            ? ts * 1'000'000'000
+                   : ts < 100'000'000'000'000      ? ts * 1'000'000
+                   : ts < 100'000'000'000'000'000  ? ts * 1'000
+                                                   : ts;
+    auto wallNs = duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+    return receiveNs - (wallNs - epochNs);
+}
+
+// Per-update stamps; zero means the stage was not stamped.
+struct UpdateTrace {
+    std::int64_t sourceNs = 0;  // produced at the source (feed "ts", converted)
+    std::int64_t receiveNs = 0; // bytes received
+    std::int64_t parseNs = 0;   // value parsed
+    std::int64_t enqueueNs = 0; // handed to RefreshData
+};
+
+// Stamps of one sampled update, kept beside the update batch; index is the update's position in that batch.
+struct SampledTrace {
+    std::size_t index;
+    UpdateTrace trace;
+};
+
+using SampledTraceBatch = std::pmr::vector<SampledTrace>;
+
+// Picks one in every period updates for latency tracing and collects their stamps, so unsampled updates carry
+// none. The count runs across batches; a period of zero samples nothing.
+class TraceSampler {
+    SampledTraceBatch m_samples;
+    std::uint32_t m_period = 0;
+    std::uint32_t m_counter = 0;
+
+  public:
+    explicit TraceSampler(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : m_samples(resource) {}
+
+    void SetPeriod(std::uint32_t period) {
+        m_period = period;
+        m_counter = 0;
+    }
+
+    // Called once per update about to be appended at position index; returns the stamps to fill in when the
+    // update is sampled, nullptr otherwise.
+    UpdateTrace *Sample(std::size_t index) {
+        if (m_period == 0 || ++m_counter < m_period)
+            return nullptr;
+        m_counter = 0;
+        return &m_samples.emplace_back(SampledTrace{.index = index, .trace = {}}).trace;
+    }
+
+    [[nodiscard]] const SampledTraceBatch &Samples() const { return m_samples; }
+
+    // Drops the collected stamps but keeps their storage.
+    void Clear() { m_samples.clear(); }
+};
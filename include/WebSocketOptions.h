@@ -0,0 +1,73 @@
+#pragma once
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+// WebSocket client settings, parsed from an option string such as "deflate=on;window=12;takeover=off".
+// window is the permessage-deflate LZ77 window size in bits (9-15) for both directions; zlib cannot produce raw
+// deflate with an 8-bit window. takeover=off resets the compression context after every message, trading ratio
+// for memory.
+struct WebSocketOptions {
+    bool deflate = false;
+    int windowBits = 15;
+    bool contextTakeover = true;
+};
+
+// Returns false on an unknown key or malformed value.
+inline bool ParseWebSocketOptions(std::string_view spec, WebSocketOptions &options) {
+    options = WebSocketOptions{};
+    auto parseSwitch = [](std::string_view value, bool &out) {
+        if (value == "on" || value == "1" || value == "true")
+            out = true;
+        else if (value == "off" || value == "0" || value == "false")
+            out = false;
+        else
+            return false;
+        return true;
+    };
+
+    while (!spec.empty()) {
+        auto sep = spec.find_first_of(";,");
+        auto item = spec.substr(0, sep);
+        spec = sep == std::string_view::npos ? std::string_view() : spec.substr(sep + 1);
+        if (item.empty())
+            continue;
+
+        auto eq = item.find('=');
+        if (eq == std::string_view::npos)
+            return false;
+        auto key = item.substr(0, eq);
+        auto value = item.substr(eq + 1);
+
+        if (key == "deflate") {
+            if (!parseSwitch(value, options.deflate))
+                return false;
+        } else if (key == "takeover") {
+            if (!parseSwitch(value, options.contextTakeover))
+                return false;
+        } else if (key == "window") {
+            auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), options.windowBits);
+            if (ec != std::errc() || ptr != value.data() + value.size() || options.windowBits < 9 ||
+                options.windowBits > 15)
+                return false;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Client offer for the permessage-deflate extension (RFC 7692) matching the options.
+inline std::string DeflateExtensionOffer(const WebSocketOptions &options) {
+    auto offer = std::string("permessage-deflate");
+    if (options.windowBits != 15) {
+        offer += "; client_max_window_bits=" + std::to_string(options.windowBits);
+        offer += "; server_max_window_bits=" + std::to_string(options.windowBits);
+    } else {
+        offer += "; client_max_window_bits";
+    }
+    if (!options.contextTakeover)
+        offer += "; client_no_context_takeover; server_no_context_takeover";
+    return offer;
+}
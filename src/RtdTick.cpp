@@ -1,35 +1,105 @@
 #include "IDataSource.h"
+#include "LatencyTrace.h"
 #include "Logger.h"
+#include "RefreshArena.h"
 #include "RtdTickLib_i.h"
 #include "ScalarSource.h"
+#include "UpdateScheduler.h"
 #include "resource.h"
 #include <WinNls.h>
+#include <algorithm>
 #include <array>
 #include <atlbase.h>
 #include <atlcom.h>
 #include <atlcomcli.h>
 #include <atlsafe.h>
+#include <atlwin.h>
 #include <atomic>
+#include <charconv>
+#include <chrono>
 #include <exception>
 #include <map>
 #include <memory>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <stringapiset.h>
 #include <utility>
 #include <vector>
 #include <windows.h>
 
-static std::string WideToUtf8String(const BSTR bstr) {
+static void WideToUtf8String(const BSTR bstr, std::pmr::string &out) {
+    out.clear();
     if (!bstr)
-        return {};
+        return;
     int size = WideCharToMultiByte(CP_UTF8, 0, bstr, -1, nullptr, 0, nullptr, nullptr);
     if (size <= 0)
-        return {};
-    std::string out(size - 1, '\0');
+        return;
+    out.resize(size - 1);
     WideCharToMultiByte(CP_UTF8, 0, bstr, -1, out.data(), size, nullptr, nullptr);
-    return out;
 }
 
+// Reads a non-negative integer environment variable; an unset variable gives fallback, and so does a value that is
+// not entirely a number, which is logged.
+static std::size_t ReadEnvironmentSize(const char *name, std::size_t fallback) {
+    char buffer[32] = {};
+    auto len = GetEnvironmentVariableA(name, buffer, static_cast<DWORD>(sizeof(buffer)));
+    if (len == 0)
+        return fallback;
+    auto text = std::string_view(buffer, len < sizeof(buffer) ? len : 0);
+    std::size_t value = 0;
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (text.empty() || ec != std::errc() || end != text.data() + text.size()) {
+        GetLogger().LogError(std::string("Invalid ") + name + " '" + std::string(text) + "', using " +
+                             std::to_string(fallback));
+        return fallback;
+    }
+    return value;
+}
+
+static constexpr auto PriorityPrefix = std::string_view("prio=");
+
+// Parses the class of a "prio=<high|normal|low>" topic string; false for an unknown class.
+static bool ParsePriorityParam(std::string_view param, TopicPriority &priority) {
+    auto cls = param.substr(PriorityPrefix.size());
+    if (cls == "high")
+        priority = TopicPriority::High;
+    else if (cls == "normal")
+        priority = TopicPriority::Normal;
+    else if (cls == "low")
+        priority = TopicPriority::Low;
+    else
+        return false;
+    return true;
+}
+
+// Hidden window used to raise UpdateNotify once RefreshData has returned, so overflow gets another cycle
+class DeferredNotifyWindow : public CWindowImpl<DeferredNotifyWindow, CWindow, CWinTraits<>> {
+    static constexpr UINT WM_DEFERRED_NOTIFY = WM_APP + 1;
+    DataAvailableCallback m_callback{};
+
+  public:
+    BEGIN_MSG_MAP(DeferredNotifyWindow)
+    MESSAGE_HANDLER(WM_DEFERRED_NOTIFY, OnDeferredNotify)
+    END_MSG_MAP()
+
+    void SetCallback(const DataAvailableCallback &callback) { m_callback = callback; }
+
+    BOOL CreateNow() { return Create(nullptr) != nullptr; }
+
+    void Post() {
+        if (m_hWnd)
+            PostMessage(WM_DEFERRED_NOTIFY);
+    }
+
+    LRESULT OnDeferredNotify(UINT, WPARAM, LPARAM, BOOL &) const {
+        if (m_callback) {
+            m_callback();
+        }
+        return 0;
+    }
+};
+
 class DECLSPEC_UUID("C5D2C3F2-FA6B-4B3A-9B6E-7B8E07C54111") RtdTick
     : public CComObjectRootEx<CComSingleThreadModel>,
       public CComCoClass<RtdTick, &__uuidof(RtdTick)>,
@@ -63,8 +133,13 @@ class DECLSPEC_UUID("C5D2C3F2-FA6B-4B3A-9B6E-7B8E07C54111") RtdTick
         if (!strings || !getNewValues || !value)
             return E_POINTER;
 
-        // Parse parameters from Excel
-        auto params = ParseTopicParams(*strings);
+        // Parse parameters from Excel; they only live for this call, so back them with a stack arena
+        auto paramBuffer = std::array<std::byte, 512>{};
+        auto paramArena = std::pmr::monotonic_buffer_resource(paramBuffer.data(), paramBuffer.size());
+        auto params = TopicParams(TopicParams::allocator_type(&paramArena));
+        if (!ParseTopicParams(*strings, params)) {
+            return E_INVALIDARG;
+        }
 
         // Find appropriate data source
         auto *source = FindDataSource(params);
@@ -80,6 +155,7 @@ class DECLSPEC_UUID("C5D2C3F2-FA6B-4B3A-9B6E-7B8E07C54111") RtdTick
 
         // Track which source handles this topic
         m_topicSources[topicId] = source;
+        m_scheduler.AddTopic(topicId, params.priority);
 
         // Return initial value
         VariantInit(value);
@@ -101,56 +177,35 @@ class DECLSPEC_UUID("C5D2C3F2-FA6B-4B3A-9B6E-7B8E07C54111") RtdTick
         if (!topicCount || !data)
             return E_POINTER;
 
-        // Collect updates from all data sources
-        std::vector<TopicUpdate> allUpdates;
-        for (auto &source : m_dataSources) {
-            auto updates = source->GetNewData();
-            allUpdates.insert(allUpdates.end(), updates.begin(), updates.end());
-        }
-
-        if (allUpdates.empty()) {
-            *topicCount = 0;
-            *data = nullptr;
-            return S_OK;
-        }
-
-        // Build 2D SAFEARRAY for Excel
-        auto bounds = std::array<CComSafeArrayBound, 2>{};
-        bounds[0].SetCount(2);
-        bounds[1].SetCount(static_cast<ULONG>(allUpdates.size()));
-        CComSafeArray<VARIANT> sa;
-        if (FAILED(sa.Create(bounds.data(), 2)))
-            return E_FAIL;
-
-        LONG col = 0;
-        for (const auto &[topicId, value] : allUpdates) {
-            // Row 0: Topic ID
-            VARIANT vTopic;
-            VariantInit(&vTopic);
-            vTopic.vt = VT_I4;
-            vTopic.lVal = topicId;
-
-            LONG idx[2] = {};
-            idx[0] = 0;
-            idx[1] = col;
-            sa.MultiDimSetAt(idx, vTopic);
-
-            // Row 1: Value
-            VARIANT vValue;
-            VariantInit(&vValue);
-            vValue.vt = VT_R8;
-            vValue.dblVal = value;
-
-            idx[0] = 1;
-            sa.MultiDimSetAt(idx, vValue);
-
-            col++;
+        HRESULT hr = S_OK;
+        {
+            // Collect updates from the sources that signalled new data into the per-cycle arena. A refresh
+            // requested only to drain overflow pulls nothing, so the backlog clears and sources tick at their own pace
+            auto allUpdates = TopicUpdateBatch(m_refreshArena.Resource());
+            allUpdates.reserve(m_topicSources.size());
+            for (std::size_t i = 0; i < m_dataSources.size(); ++i) {
+                if (m_sourceReady[i].exchange(false, std::memory_order_acq_rel))
+                    m_dataSources[i]->GetNewData(allUpdates, m_traceSampler);
+            }
+            m_scheduler.Post(allUpdates, m_traceSampler.Samples());
+            m_traceSampler.Clear();
+
+            // Hand Excel at most one capped, priority-ordered batch; the rest stays pending
+            auto batch = TopicUpdateBatch(m_refreshArena.Resource());
+            auto traces = SampledTraceBatch(m_refreshArena.Resource());
+            m_scheduler.Drain(batch, &traces);
+            if (!traces.empty())
+                TraceDrained(batch, traces);
+            hr = BuildUpdateArray(batch, topicCount, data);
         }
 
-        *topicCount = static_cast<long>(allUpdates.size());
-        *data = sa.Detach();
+        // The SAFEARRAY owns its own copy, so everything the cycle allocated can be dropped at once
+        m_refreshArena.Reset();
 
-        return S_OK;
+        // Overflow is picked up by another RefreshData, requested once this one has returned
+        if (m_scheduler.HasPending())
+            m_notifyWindow.Post();
+        return hr;
     }
 
     STDMETHOD(DisconnectData)(long topicId) override {
@@ -163,6 +218,7 @@ class DECLSPEC_UUID("C5D2C3F2-FA6B-4B3A-9B6E-7B8E07C54111") RtdTick
             }
             m_topicSources.erase(it);
         }
+        m_scheduler.RemoveTopic(topicId);
         return S_OK;
     }
 
@@ -194,6 +250,7 @@ class DECLSPEC_UUID("C5D2C3F2-FA6B-4B3A-9B6E-7B8E07C54111") RtdTick
             // Clear topic->source map first to avoid dangling pointers when data sources are destroyed
             try {
                 m_topicSources.clear();
+                m_scheduler.Clear();
             } catch (const std::exception &e) {
                 GetLogger().LogError(e.what());
             }
@@ -207,6 +264,12 @@ class DECLSPEC_UUID("C5D2C3F2-FA6B-4B3A-9B6E-7B8E07C54111") RtdTick
                 }
             }
 
+            if (m_notifyWindow.m_hWnd)
+                m_notifyWindow.DestroyWindow();
+
+            // Flushes the last latency snapshot
+            m_tracer.Stop();
+
             // Clear data structures (unique_ptr destructors will destroy windows)
             try {
                 m_dataSources.clear();
@@ -234,8 +297,89 @@ class DECLSPEC_UUID("C5D2C3F2-FA6B-4B3A-9B6E-7B8E07C54111") RtdTick
     // Registered data sources
     std::vector<std::unique_ptr<IDataSource>> m_dataSources;
 
+    // Set by a source's data-available callback and consumed by the next RefreshData; indices follow m_dataSources
+    std::unique_ptr<std::atomic<bool>[]> m_sourceReady;
+
+    // Pooled storage for long-lived per-topic state; subscribe/unsubscribe churn reuses freed nodes
+    std::pmr::unsynchronized_pool_resource m_topicPool;
+
     // Map from topicId to the data source handling it
-    std::map<long, IDataSource *> m_topicSources;
+    std::pmr::map<long, IDataSource *> m_topicSources{&m_topicPool};
+
+    // Pending values and their priority order across RefreshData calls
+    UpdateScheduler m_scheduler;
+
+    // Backing storage for the update batch of a single RefreshData call
+    RefreshArena m_refreshArena;
+
+    DeferredNotifyWindow m_notifyWindow;
+
+    // Picks the source updates that carry stamps; its period stays 0 unless the tracer started
+    TraceSampler m_traceSampler;
+
+    // Sampled per-source stage latencies; indices follow m_dataSources
+    LatencyTracer m_tracer;
+
+    void TraceDrained(const TopicUpdateBatch &batch, const SampledTraceBatch &traces) {
+        auto drainNs = TraceNow();
+        for (const auto &sample : traces) {
+            auto it = m_topicSources.find(batch[sample.index].topicId);
+            if (it == m_topicSources.end())
+                continue;
+            for (std::size_t i = 0; i < m_dataSources.size(); ++i) {
+                if (m_dataSources[i].get() == it->second) {
+                    m_tracer.Record(i, sample.trace, drainNs);
+                    break;
+                }
+            }
+        }
+    }
+
+    static HRESULT BuildUpdateArray(const TopicUpdateBatch &updates, long *topicCount, SAFEARRAY **data) {
+        if (updates.empty()) {
+            *topicCount = 0;
+            *data = nullptr;
+            return S_OK;
+        }
+
+        // Build 2D SAFEARRAY for Excel
+        auto bounds = std::array<CComSafeArrayBound, 2>{};
+        bounds[0].SetCount(2);
+        bounds[1].SetCount(static_cast<ULONG>(updates.size()));
+        CComSafeArray<VARIANT> sa;
+        if (FAILED(sa.Create(bounds.data(), 2)))
+            return E_FAIL;
+
+        LONG col = 0;
+        for (const auto &update : updates) {
+            // Row 0: Topic ID
+            VARIANT vTopic;
+            VariantInit(&vTopic);
+            vTopic.vt = VT_I4;
+            vTopic.lVal = update.topicId;
+
+            LONG idx[2] = {};
+            idx[0] = 0;
+            idx[1] = col;
+            sa.MultiDimSetAt(idx, vTopic);
+
+            // Row 1: Value
+            VARIANT vValue;
+            VariantInit(&vValue);
+            vValue.vt = VT_R8;
+            vValue.dblVal = update.value;
+
+            idx[0] = 1;
+            sa.MultiDimSetAt(idx, vValue);
+
+            col++;
+        }
+
+        *topicCount = static_cast<long>(updates.size());
+        *data = sa.Detach();
+
+        return S_OK;
+    }
 
     void RegisterDataSources() {
         // Create callback that notifies Excel when data is available
@@ -253,44 +397,84 @@ class DECLSPEC_UUID("C5D2C3F2-FA6B-4B3A-9B6E-7B8E07C54111") RtdTick
             }
         };
 
+        if (m_notifyWindow.CreateNow()) {
+            m_notifyWindow.SetCallback(notifyCallback);
+        }
+
+        // Refresh batch limits: RTD_MAX_UPDATES_PER_REFRESH (0 = unbounded), RTD_PRIORITY_AGING_CYCLES (0 = off)
+        auto maxUpdates =
+            ReadEnvironmentSize("RTD_MAX_UPDATES_PER_REFRESH", UpdateScheduler::DefaultMaxUpdatesPerRefresh);
+        auto agingCycles = ReadEnvironmentSize("RTD_PRIORITY_AGING_CYCLES", UpdateScheduler::DefaultAgingCycles);
+        m_scheduler.Configure(maxUpdates, agingCycles);
+        GetLogger().LogInfo("REFRESH_LIMITS: MaxUpdatesPerRefresh=" + std::to_string(maxUpdates) +
+                            ", AgingCycles=" + std::to_string(agingCycles));
+
         // Register Legacy random data source
-        auto legacySource = std::make_unique<ScalarSource>();
-        legacySource->Initialize(notifyCallback);
-        m_dataSources.push_back(std::move(legacySource));
-    }
+        m_dataSources.push_back(std::make_unique<ScalarSource>());
+
+        // Each source marks itself ready before notifying, so RefreshData only pulls from sources with new data
+        m_sourceReady = std::make_unique<std::atomic<bool>[]>(m_dataSources.size());
+        for (std::size_t i = 0; i < m_dataSources.size(); ++i) {
+            m_dataSources[i]->Initialize([this, i, notifyCallback]() {
+                m_sourceReady[i].store(true, std::memory_order_release);
+                notifyCallback();
+            });
+        }
 
-    TopicParams ParseTopicParams(SAFEARRAY *sa) const {
-        TopicParams params;
+        // Latency tracing: RTD_TRACE_SAMPLE stamps one in N source updates (0 = off),
+        // RTD_TRACE_INTERVAL_MS sets how often percentile snapshots are written (at least 100 ms)
+        for (auto &source : m_dataSources) {
+            m_tracer.AddSource(source->GetSourceName());
+        }
+        auto samplePeriod = ReadEnvironmentSize("RTD_TRACE_SAMPLE", 64);
+        auto interval = std::max(std::chrono::milliseconds(ReadEnvironmentSize("RTD_TRACE_INTERVAL_MS", 10000)),
+                                 LatencyTracer::MinInterval);
+        if (samplePeriod != 0) {
+            auto path = Logger::MakeLogFilePath("RTD_latency", ".csv");
+            if (!path.empty() && m_tracer.Start(interval, path)) {
+                m_traceSampler.SetPeriod(static_cast<std::uint32_t>(samplePeriod));
+                GetLogger().LogInfo("LATENCY_TRACE: SamplePeriod=" + std::to_string(samplePeriod) +
+                                    ", IntervalMs=" + std::to_string(interval.count()) + ", File='" + path + "'");
+            } else {
+                GetLogger().LogError("Failed to start latency tracing");
+            }
+        }
+    }
 
+    // Fills params from Excel's topic strings; false (and logged) for an unknown priority class.
+    static bool ParseTopicParams(SAFEARRAY *sa, TopicParams &params) {
         LONG lBound = 0, uBound = 0;
         SafeArrayGetLBound(sa, 1, &lBound);
         SafeArrayGetUBound(sa, 1, &uBound);
 
-        // First parameter
-        if (lBound <= uBound) {
+        // Positional parameters fill param1/param2 in order; "prio=..." may appear anywhere and takes no slot
+        auto text = std::pmr::string(params.param1.get_allocator());
+        int slot = 0;
+        for (LONG idx = lBound; idx <= uBound; ++idx) {
             VARIANT v;
             VariantInit(&v);
-            LONG idx = lBound;
             SafeArrayGetElement(sa, &idx, &v);
+            text.clear();
             if (v.vt == VT_BSTR) {
-                params.param1 = WideToUtf8String(v.bstrVal);
+                WideToUtf8String(v.bstrVal, text);
             }
             VariantClear(&v);
-        }
 
-        // Second parameter
-        if (lBound + 1 <= uBound) {
-            VARIANT v;
-            VariantInit(&v);
-            LONG idx = lBound + 1;
-            SafeArrayGetElement(sa, &idx, &v);
-            if (v.vt == VT_BSTR) {
-                params.param2 = WideToUtf8String(v.bstrVal);
+            if (text.starts_with(PriorityPrefix)) {
+                if (!ParsePriorityParam(text, params.priority)) {
+                    GetLogger().LogError("Invalid topic priority '" + std::string(text) + "'");
+                    return false;
+                }
+                continue;
             }
-            VariantClear(&v);
+            if (slot == 0)
+                params.param1 = text;
+            else if (slot == 1)
+                params.param2 = text;
+            slot++;
         }
 
-        return params;
+        return true;
     }
 
     IDataSource *FindDataSource(const TopicParams &params) const {
@@ -1,4 +1,5 @@
 #include "ScalarSource.h"
+#include "SyntheticMarket.h"
 #include <IDataSource.h>
 #include <Logger.h>
 #include <Windows.h>
@@ -6,10 +7,10 @@
 #include <atlwin.h>
 #include <exception>
 #include <memory>
-#include <random>
-#include <set>
+#include <memory_resource>
 #include <string>
 #include <sysinfoapi.h>
+#include <unordered_map>
 #include <vector>
 
 class ScalarTimerWindow : public CWindowImpl<ScalarTimerWindow, CWindow, CWinTraits<>> {
@@ -45,13 +46,12 @@ class ScalarTimerWindow : public CWindowImpl<ScalarTimerWindow, CWindow, CWinTra
 struct ScalarSource::Impl {
     ScalarTimerWindow timerWindow;
     DataAvailableCallback callback;
-    std::set<long> topics;
-    std::mt19937_64 rng;
-    std::uniform_real_distribution<double> dist;
+    std::pmr::unsynchronized_pool_resource topicPool;
 
-    Impl() : rng(static_cast<unsigned int>(GetTickCount64())), dist(0.0, 1.0) {}
-
-    double NextRand() { return dist(rng) * 100.0; }
+    // Market slots are dense; topicIds[slot] and slots[topicId] map between the two
+    SyntheticMarket market{GetTickCount64(), &topicPool};
+    std::pmr::vector<long> topicIds{&topicPool};
+    std::pmr::unordered_map<long, std::size_t> slots{&topicPool};
 };
 
 ScalarSource::ScalarSource() : pImpl(std::make_unique<Impl>()) {}
@@ -74,27 +74,59 @@ void ScalarSource::Initialize(DataAvailableCallback callback) {
 
 bool ScalarSource::Subscribe(long topicId, const TopicParams &params, double &initialValue) {
     GetLogger().LogSubscription(topicId, params.param1, "");
-    pImpl->topics.insert(topicId);
-    if (pImpl->topics.size() == 1)
+
+    // A second topic string with "=" selects the price model, e.g. "model=gbm;start=100;vol=0.002;tick=0.01".
+    // Anything else is a plain tag that only keeps topics distinct (e.g. "A1") and gets the uniform model
+    auto model = PriceModelParams{};
+    if (IsPriceModelSpec(params.param2) && !ParsePriceModelParams(params.param2, model)) {
+        GetLogger().LogError("Invalid price model '" + std::string(params.param2) + "' for TopicID=" +
+                             std::to_string(topicId));
+        return false;
+    }
+    if (pImpl->slots.contains(topicId))
+        Unsubscribe(topicId);
+
+    auto slot = pImpl->market.Add(model);
+    pImpl->topicIds.push_back(topicId);
+    pImpl->slots[topicId] = slot;
+    if (pImpl->topicIds.size() == 1)
         pImpl->timerWindow.StartTimer(1000);
-    initialValue = pImpl->NextRand();
+    initialValue = pImpl->market.Price(slot);
     return true;
 }
 
 void ScalarSource::Unsubscribe(long topicId) {
     GetLogger().LogUnsubscribe(topicId);
-    pImpl->topics.erase(topicId);
-    if (pImpl->topics.empty())
+    auto it = pImpl->slots.find(topicId);
+    if (it == pImpl->slots.end())
+        return;
+
+    // Swap-remove: the last slot moves into the freed one
+    auto slot = it->second;
+    pImpl->slots.erase(it);
+    pImpl->market.Remove(slot);
+    pImpl->topicIds[slot] = pImpl->topicIds.back();
+    pImpl->topicIds.pop_back();
+    if (slot < pImpl->topicIds.size())
+        pImpl->slots[pImpl->topicIds[slot]] = slot;
+
+    if (pImpl->topicIds.empty())
         pImpl->timerWindow.StopTimer();
 }
 
-std::vector<TopicUpdate> ScalarSource::GetNewData() {
-    std::vector<TopicUpdate> updates;
-    for (auto topicId : pImpl->topics) {
-        auto u = TopicUpdate{.topicId = topicId, .value = pImpl->NextRand()};
-        updates.push_back(u);
+void ScalarSource::GetNewData(TopicUpdateBatch &updates, TraceSampler &sampler) {
+    // Generated locally, so there is no wire stage (sourceNs stays 0); the generator pass stands in for parsing
+    auto generatedNs = TraceNow();
+    pImpl->market.Step();
+    auto steppedNs = TraceNow();
+    auto stamps = UpdateTrace{.receiveNs = generatedNs, .parseNs = steppedNs, .enqueueNs = steppedNs};
+
+    const auto *prices = pImpl->market.Prices();
+    for (std::size_t slot = 0; slot < pImpl->topicIds.size(); ++slot) {
+        if (auto *trace = sampler.Sample(updates.size()))
+            *trace = stamps;
+        updates.push_back(TopicUpdate{.topicId = pImpl->topicIds[slot], .value = prices[slot]});
     }
-    return updates;
 }
 
 bool ScalarSource::CanHandle(const TopicParams &params) const {
@@ -103,7 +135,9 @@ bool ScalarSource::CanHandle(const TopicParams &params) const {
 
 void ScalarSource::Shutdown() {
     pImpl->timerWindow.StopTimer();
-    pImpl->topics.clear();
+    pImpl->slots.clear();
+    pImpl->topicIds.clear();
+    pImpl->market.Clear();
 }
 
 std::string ScalarSource::GetSourceName() const { return "ScalarRandom"; }
@@ -0,0 +1,272 @@
+#include "SyntheticMarket.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string_view>
+#include <system_error>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define SYNTHETIC_MARKET_X64 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SYNTHETIC_MARKET_AVX2
+#else
+#define SYNTHETIC_MARKET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+
+constexpr float Sqrt3 = 1.7320508f;
+constexpr float Inv24 = 1.0f / 16777216.0f;
+
+// 32-bit integer hash with full avalanche (lowbias32).
+inline std::uint32_t Hash32(std::uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+inline float UniformFromHash(std::uint32_t h) { return static_cast<float>(h >> 8) * Inv24; }
+
+// Counter-based draw: the counter is hashed before the step key is mixed in, so different keys do not read shifted
+// windows of one sequence (as adding the key to the counter would).
+inline std::uint32_t Draw(std::uint32_t counter, std::uint32_t key) { return Hash32(Hash32(counter) ^ key); }
+
+// from_chars also accepts "nan" and "inf"; a non-finite setting would turn every later price into NaN or inf.
+bool ParseDouble(std::string_view text, double &value) {
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return ec == std::errc() && ptr == text.data() + text.size() && std::isfinite(value);
+}
+
+} // namespace
+
+bool IsPriceModelSpec(std::string_view param) { return param.find('=') != std::string_view::npos; }
+
+bool ParsePriceModelParams(std::string_view spec, PriceModelParams &params) {
+    params = PriceModelParams{};
+    bool volSet = false;
+    while (!spec.empty()) {
+        auto sep = spec.find_first_of(";,");
+        auto item = spec.substr(0, sep);
+        spec = sep == std::string_view::npos ? std::string_view() : spec.substr(sep + 1);
+        if (item.empty())
+            continue;
+
+        auto eq = item.find('=');
+        if (eq == std::string_view::npos)
+            return false;
+        auto key = item.substr(0, eq);
+        auto value = item.substr(eq + 1);
+
+        if (key == "model") {
+            if (value == "uniform")
+                params.model = PriceModel::Uniform;
+            else if (value == "walk")
+                params.model = PriceModel::RandomWalk;
+            else if (value == "gbm")
+                params.model = PriceModel::Geometric;
+            else
+                return false;
+        } else if (key == "start") {
+            if (!ParseDouble(value, params.start))
+                return false;
+        } else if (key == "drift") {
+            if (!ParseDouble(value, params.drift))
+                return false;
+        } else if (key == "vol") {
+            if (!ParseDouble(value, params.vol))
+                return false;
+            volSet = true;
+        } else if (key == "tick") {
+            if (!ParseDouble(value, params.tick))
+                return false;
+        } else {
+            return false;
+        }
+    }
+
+    if (!volSet)
+        params.vol = params.model == PriceModel::Geometric ? 0.001 : params.model == PriceModel::RandomWalk ? 0.1 : 0.0;
+    return params.start >= 0.0 && params.vol >= 0.0 && params.tick >= 0.0;
+}
+
+SyntheticMarket::SyntheticMarket(std::uint64_t seed, std::pmr::memory_resource *resource)
+    : m_seed(seed), m_vectorized(CpuHasAvx2()), m_state(resource), m_price(resource), m_drift(resource),
+      m_vol(resource), m_geometric(resource), m_uniform(resource), m_tick(resource), m_invTick(resource) {}
+
+bool SyntheticMarket::CpuHasAvx2() {
+#if defined(SYNTHETIC_MARKET_X64) && defined(_MSC_VER)
+    int info[4] = {};
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif defined(SYNTHETIC_MARKET_X64)
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+void SyntheticMarket::SetVectorized(bool enable) { m_vectorized = enable && CpuHasAvx2(); }
+
+std::size_t SyntheticMarket::Add(const PriceModelParams &params) {
+    auto slot = m_price.size();
+    m_state.push_back(params.start);
+    m_price.push_back(params.start);
+    m_drift.push_back(params.drift);
+    m_vol.push_back(params.vol);
+    m_geometric.push_back(params.model == PriceModel::Geometric ? 1.0 : 0.0);
+    m_uniform.push_back(params.model == PriceModel::Uniform ? 1.0 : 0.0);
+    m_tick.push_back(params.tick);
+    m_invTick.push_back(params.tick > 0.0 ? 1.0 / params.tick : 0.0);
+
+    if (params.model == PriceModel::Uniform) {
+        // Uniform topics start from a draw (outside the key sequence Step uses) rather than the start price
+        StepScalar(slot, slot + 1, ~StepKey());
+    } else if (params.tick > 0.0) {
+        m_price[slot] = std::nearbyint(params.start * m_invTick[slot]) * params.tick;
+    }
+    return slot;
+}
+
+void SyntheticMarket::Remove(std::size_t slot) {
+    auto removeAt = [slot](std::pmr::vector<double> &column) {
+        column[slot] = column.back();
+        column.pop_back();
+    };
+    removeAt(m_state);
+    removeAt(m_price);
+    removeAt(m_drift);
+    removeAt(m_vol);
+    removeAt(m_geometric);
+    removeAt(m_uniform);
+    removeAt(m_tick);
+    removeAt(m_invTick);
+}
+
+void SyntheticMarket::Clear() {
+    for (auto *column : {&m_state, &m_price, &m_drift, &m_vol, &m_geometric, &m_uniform, &m_tick, &m_invTick})
+        column->clear();
+}
+
+std::uint32_t SyntheticMarket::StepKey() const {
+    return Hash32(static_cast<std::uint32_t>(m_step) ^ static_cast<std::uint32_t>(m_seed)) ^
+           static_cast<std::uint32_t>(m_seed >> 32);
+}
+
+void SyntheticMarket::Step() {
+    auto key = StepKey();
+    ++m_step;
+
+    std::size_t done = 0;
+#ifdef SYNTHETIC_MARKET_X64
+    if (m_vectorized) {
+        done = Size() - Size() % 8;
+        StepAvx2(0, done, key);
+    }
+#endif
+    StepScalar(done, Size(), key);
+}
+
+void SyntheticMarket::StepScalar(std::size_t begin, std::size_t end, std::uint32_t key) {
+    for (auto i = begin; i < end; ++i) {
+        auto base = static_cast<std::uint32_t>(i) * 4U;
+        auto u0 = UniformFromHash(Draw(base, key));
+        auto u1 = UniformFromHash(Draw(base + 1, key));
+        auto u2 = UniformFromHash(Draw(base + 2, key));
+        auto u3 = UniformFromHash(Draw(base + 3, key));
+        auto z = static_cast<double>((u0 + u1 + u2 + u3 - 2.0f) * Sqrt3);
+
+        auto p = m_state[i];
+        auto scale = m_geometric[i] > 0.0 ? p : 1.0;
+        auto next = std::max(p + scale * (m_drift[i] + m_vol[i] * z), 0.0);
+        if (m_uniform[i] > 0.0)
+            next = static_cast<double>(u0) * 100.0;
+
+        m_state[i] = next;
+        m_price[i] = m_tick[i] > 0.0 ? std::nearbyint(next * m_invTick[i]) * m_tick[i] : next;
+    }
+}
+
+#ifdef SYNTHETIC_MARKET_X64
+namespace {
+
+SYNTHETIC_MARKET_AVX2 inline __m256i Hash8(__m256i x) {
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32(0x7feb352d));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 15));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32(static_cast<int>(0x846ca68bU)));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+    return x;
+}
+
+SYNTHETIC_MARKET_AVX2 inline __m256i Draw8(__m256i counter, __m256i key) {
+    return Hash8(_mm256_xor_si256(Hash8(counter), key));
+}
+
+SYNTHETIC_MARKET_AVX2 inline __m256 Uniform8(__m256i h) {
+    return _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(h, 8)), _mm256_set1_ps(Inv24));
+}
+
+} // namespace
+
+SYNTHETIC_MARKET_AVX2 void SyntheticMarket::StepAvx2(std::size_t begin, std::size_t end, std::uint32_t key) {
+    const auto laneOffsets = _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+    const auto zero = _mm256_setzero_pd();
+    const auto one = _mm256_set1_pd(1.0);
+    const auto hundred = _mm256_set1_pd(100.0);
+    const auto keys = _mm256_set1_epi32(static_cast<int>(key));
+
+    // Four slots of doubles at a time, fed by one half of the eight float lanes
+    auto stepHalf = [&](std::size_t j, __m256d z, __m256d u0) SYNTHETIC_MARKET_AVX2 {
+        auto p = _mm256_loadu_pd(&m_state[j]);
+        auto geometric = _mm256_cmp_pd(_mm256_loadu_pd(&m_geometric[j]), zero, _CMP_GT_OQ);
+        auto uniform = _mm256_cmp_pd(_mm256_loadu_pd(&m_uniform[j]), zero, _CMP_GT_OQ);
+        auto tick = _mm256_loadu_pd(&m_tick[j]);
+        auto hasTick = _mm256_cmp_pd(tick, zero, _CMP_GT_OQ);
+
+        auto scale = _mm256_blendv_pd(one, p, geometric);
+        auto shock = _mm256_add_pd(_mm256_loadu_pd(&m_drift[j]), _mm256_mul_pd(_mm256_loadu_pd(&m_vol[j]), z));
+        auto next = _mm256_max_pd(_mm256_add_pd(p, _mm256_mul_pd(scale, shock)), zero);
+        next = _mm256_blendv_pd(next, _mm256_mul_pd(u0, hundred), uniform);
+
+        auto rounded = _mm256_mul_pd(
+            _mm256_round_pd(_mm256_mul_pd(next, _mm256_loadu_pd(&m_invTick[j])),
+                            _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC),
+            tick);
+        _mm256_storeu_pd(&m_state[j], next);
+        _mm256_storeu_pd(&m_price[j], _mm256_blendv_pd(next, rounded, hasTick));
+    };
+
+    for (auto i = begin; i + 8 <= end; i += 8) {
+        auto counter = static_cast<int>(static_cast<std::uint32_t>(i) * 4U);
+        auto base = _mm256_add_epi32(_mm256_set1_epi32(counter), laneOffsets);
+        auto u0 = Uniform8(Draw8(base, keys));
+        auto u1 = Uniform8(Draw8(_mm256_add_epi32(base, _mm256_set1_epi32(1)), keys));
+        auto u2 = Uniform8(Draw8(_mm256_add_epi32(base, _mm256_set1_epi32(2)), keys));
+        auto u3 = Uniform8(Draw8(_mm256_add_epi32(base, _mm256_set1_epi32(3)), keys));
+        auto sum = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(u0, u1), u2), u3);
+        auto z = _mm256_mul_ps(_mm256_sub_ps(sum, _mm256_set1_ps(2.0f)), _mm256_set1_ps(Sqrt3));
+
+        stepHalf(i, _mm256_cvtps_pd(_mm256_castps256_ps128(z)), _mm256_cvtps_pd(_mm256_castps256_ps128(u0)));
+        stepHalf(i + 4, _mm256_cvtps_pd(_mm256_extractf128_ps(z, 1)), _mm256_cvtps_pd(_mm256_extractf128_ps(u0, 1)));
+    }
+}
+#else
+void SyntheticMarket::StepAvx2(std::size_t begin, std::size_t end, std::uint32_t key) { StepScalar(begin, end, key); }
+#endif
@@ -0,0 +1,117 @@
+// Allocation-counting harness: asserts that steady-state ticking through the refresh pipeline never reaches the
+// global heap. Drives the real ScalarSource through the same arena-backed batches and capped UpdateScheduler
+// that RtdTick::RefreshData uses.
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#include "RefreshArena.h"
+#include "ScalarSource.h"
+#include "UpdateScheduler.h"
+
+static std::atomic<bool> g_counting{false};
+static std::atomic<std::size_t> g_allocations{0};
+
+static void *CountedAlloc(std::size_t size) {
+    if (g_counting.load(std::memory_order_relaxed))
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+static void *CountedAlignedAlloc(std::size_t size, std::align_val_t alignment) {
+    if (g_counting.load(std::memory_order_relaxed))
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto *p = _aligned_malloc(size ? size : 1, static_cast<std::size_t>(alignment)))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size) { return CountedAlloc(size); }
+void *operator new[](std::size_t size) { return CountedAlloc(size); }
+void *operator new(std::size_t size, std::align_val_t alignment) { return CountedAlignedAlloc(size, alignment); }
+void *operator new[](std::size_t size, std::align_val_t alignment) { return CountedAlignedAlloc(size, alignment); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { _aligned_free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { _aligned_free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { _aligned_free(p); }
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { _aligned_free(p); }
+
+int main() {
+    constexpr std::size_t topicCount = 10000;
+    // Lets the arena and pending queues reach their high-water marks as aging redistributes topics
+    constexpr int warmupTicks = 32;
+    constexpr int measuredTicks = 1000;
+    constexpr std::size_t maxUpdatesPerRefresh = 2500;
+
+    // Not initialized: no timer window is created and ticks are driven directly
+    ScalarSource source;
+    UpdateScheduler scheduler(maxUpdatesPerRefresh);
+    auto params = TopicParams{};
+    params.param1 = "RAND1S";
+    for (long topicId = 1; topicId <= static_cast<long>(topicCount); ++topicId) {
+        double initialValue = 0.0;
+        source.Subscribe(topicId, params, initialValue);
+        scheduler.AddTopic(topicId, static_cast<TopicPriority>(topicId % TopicPriorityCount));
+    }
+
+    // One source tick followed by the overflow-only refreshes RtdTick::RefreshData runs until nothing is pending,
+    // with latency sampling at the default period
+    RefreshArena arena;
+    TraceSampler sampler;
+    sampler.SetPeriod(64);
+    constexpr auto refreshesPerTick = (topicCount + maxUpdatesPerRefresh - 1) / maxUpdatesPerRefresh;
+    auto tick = [&]() {
+        for (std::size_t refresh = 0; refresh < refreshesPerTick; ++refresh) {
+            {
+                auto allUpdates = TopicUpdateBatch(arena.Resource());
+                if (refresh == 0) {
+                    allUpdates.reserve(topicCount);
+                    source.GetNewData(allUpdates, sampler);
+                    if (allUpdates.size() != topicCount) {
+                        std::cerr << "Unexpected update count " << allUpdates.size() << std::endl;
+                        std::exit(1);
+                    }
+                    scheduler.Post(allUpdates, sampler.Samples());
+                    sampler.Clear();
+                }
+
+                auto batch = TopicUpdateBatch(arena.Resource());
+                auto traces = SampledTraceBatch(arena.Resource());
+                scheduler.Drain(batch, &traces);
+                if (batch.size() != maxUpdatesPerRefresh) {
+                    std::cerr << "Unexpected batch size " << batch.size() << std::endl;
+                    std::exit(1);
+                }
+            }
+            arena.Reset();
+        }
+        if (scheduler.HasPending()) {
+            std::cerr << "Backlog did not clear: " << scheduler.PendingCount() << " pending" << std::endl;
+            std::exit(1);
+        }
+    };
+
+    for (int i = 0; i < warmupTicks; ++i)
+        tick();
+
+    g_counting = true;
+    for (int i = 0; i < measuredTicks; ++i)
+        tick();
+    g_counting = false;
+
+    auto allocations = g_allocations.load();
+    std::cout << "Ticks: " << measuredTicks << ", topics: " << topicCount << ", arena: " << arena.Capacity()
+              << " bytes, heap allocations: " << allocations << std::endl;
+    if (allocations != 0) {
+        std::cerr << "FAILED: steady-state ticking allocated from the global heap" << std::endl;
+        return 1;
+    }
+    std::cout << "PASSED" << std::endl;
+    return 0;
+}
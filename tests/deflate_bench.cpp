@@ -0,0 +1,343 @@
+// permessage-deflate benchmark for WebSocket feeds: connects to feed_simulator without and with compression and,
+// at each simulator tick rate, reports message throughput, client CPU per message and bytes on the wire.
+//
+//   feed_simulator --deflate on --allow-rate-control --mode batch --symbols 1000
+//   deflate_bench [--host 127.0.0.1] [--port 8080] [--path /] [--rates 1000,10000,100000] [--seconds 5]
+//                 [--options "window=15;takeover=on"]
+//
+// --options uses the WebSocketOptions.h syntax; the compressed run always has deflate=on and stops with an error
+// when the simulator does not accept the extension. The tick rate is set through the simulator's {"rate":N} control
+// message, so the simulator must allow it; rows whose measured tick rate is off the requested one by more than 2x are
+// marked. Wire bytes come from the kernel TCP counters of the client socket (TCP_INFO / SIO_TCP_INFO, Windows 10
+// 1703 or later; 0 otherwise).
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <mstcpip.h>
+#include <windows.h>
+#else
+#include <linux/tcp.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <time.h>
+#endif
+
+#include <libwebsockets.h>
+
+#include "WebSocketOptions.h"
+
+struct BenchOptions {
+    std::string host = "127.0.0.1";
+    int port = 8080;
+    std::string path = "/";
+    std::vector<double> rates = {1000, 10000, 100000};
+    int seconds = 5;
+    WebSocketOptions compressed{.deflate = true};
+};
+
+struct BenchState {
+    struct lws *wsi = nullptr;
+    bool connected = false;
+    bool closed = false;
+    bool deflateNegotiated = false;
+    bool controlFailed = false;
+
+    // Reassembly buffer for fragmented messages; inflated payloads are appended in place and the capacity is
+    // reused across messages
+    std::string message;
+    std::uint64_t messages = 0;
+    std::uint64_t ticks = 0;
+    std::uint64_t payloadBytes = 0;
+
+    std::string control;
+    std::vector<unsigned char> sendBuffer;
+};
+
+static BenchState g_state;
+
+// Every feed_simulator tick is one {"topic":...} object, whether sent alone or in a batch
+static std::uint64_t count_ticks(std::string_view message) {
+    static constexpr auto TickKey = std::string_view("\"topic\"");
+    std::uint64_t ticks = 0;
+    for (auto pos = message.find(TickKey); pos != std::string_view::npos; pos = message.find(TickKey, pos + 1))
+        ++ticks;
+    return ticks;
+}
+
+// The Sec-WebSocket-Extensions response header names the extensions the server accepted
+static bool deflate_accepted(struct lws *wsi) {
+    char extensions[256];
+    auto len = lws_hdr_copy(wsi, extensions, static_cast<int>(sizeof(extensions)), WSI_TOKEN_EXTENSIONS);
+    return len > 0 && std::string_view(extensions, static_cast<std::size_t>(len)).find("permessage-deflate") !=
+                          std::string_view::npos;
+}
+
+static int ws_callback(struct lws *wsi, enum lws_callback_reasons reason, void *user, void *in, size_t len) {
+    switch (reason) {
+    case LWS_CALLBACK_CLIENT_ESTABLISHED:
+        g_state.wsi = wsi;
+        g_state.connected = true;
+        g_state.deflateNegotiated = deflate_accepted(wsi);
+        break;
+    case LWS_CALLBACK_CLIENT_RECEIVE:
+        g_state.message.append(static_cast<const char *>(in), len);
+        if (lws_is_final_fragment(wsi)) {
+            g_state.messages++;
+            g_state.ticks += count_ticks(g_state.message);
+            g_state.payloadBytes += g_state.message.size();
+            g_state.message.clear();
+        }
+        break;
+    case LWS_CALLBACK_CLIENT_WRITEABLE:
+        if (!g_state.control.empty()) {
+            g_state.sendBuffer.resize(LWS_PRE + g_state.control.size());
+            std::memcpy(g_state.sendBuffer.data() + LWS_PRE, g_state.control.data(), g_state.control.size());
+            auto written =
+                lws_write(wsi, g_state.sendBuffer.data() + LWS_PRE, g_state.control.size(), LWS_WRITE_TEXT);
+            if (written < static_cast<int>(g_state.control.size()))
+                g_state.controlFailed = true;
+            g_state.control.clear();
+        }
+        break;
+    case LWS_CALLBACK_CLIENT_CONNECTION_ERROR:
+        std::cerr << "Connection error" << std::endl;
+        g_state.closed = true;
+        break;
+    case LWS_CALLBACK_CLIENT_CLOSED:
+        g_state.closed = true;
+        break;
+    default:
+        break;
+    }
+    return 0;
+}
+
+static struct lws_protocols protocols[] = {{"rtd-protocol", ws_callback, 0, 65536}, {nullptr, nullptr, 0, 0}};
+
+static std::uint64_t wire_bytes_received(struct lws *wsi) {
+    auto fd = lws_get_socket_fd(wsi);
+#ifdef _WIN32
+    DWORD version = 0;
+    TCP_INFO_v0 info{};
+    DWORD returned = 0;
+    if (WSAIoctl(fd, SIO_TCP_INFO, &version, sizeof(version), &info, sizeof(info), &returned, nullptr, nullptr) != 0)
+        return 0;
+    return info.BytesIn;
+#else
+    tcp_info info{};
+    socklen_t len = sizeof(info);
+    if (getsockopt(fd, IPPROTO_TCP, TCP_INFO, &info, &len) != 0)
+        return 0;
+    return info.tcpi_bytes_received;
+#endif
+}
+
+static double process_cpu_seconds() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+        return 0.0;
+    auto seconds = [](const FILETIME &ft) {
+        return static_cast<double>(static_cast<std::uint64_t>(ft.dwHighDateTime) << 32 | ft.dwLowDateTime) * 1e-7;
+    };
+    return seconds(kernel) + seconds(user);
+#else
+    timespec ts{};
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+#endif
+}
+
+static void service_for(struct lws_context *context, std::chrono::steady_clock::duration duration) {
+    auto deadline = std::chrono::steady_clock::now() + duration;
+    while (!g_state.closed && std::chrono::steady_clock::now() < deadline)
+        lws_service(context, 0);
+}
+
+// A row whose tick rate is this far off the requested one did not measure that rate
+static constexpr double RateTolerance = 2.0;
+
+static bool run_config(const char *label, const WebSocketOptions &options, const BenchOptions &bench,
+                       bool &rateMismatch) {
+    g_state = BenchState{};
+    g_state.message.reserve(1 << 20);
+
+    auto offer = DeflateExtensionOffer(options);
+    const struct lws_extension extensions[] = {
+        {"permessage-deflate", lws_extension_callback_pm_deflate, offer.c_str()}, {nullptr, nullptr, nullptr}};
+
+    struct lws_context_creation_info info;
+    memset(&info, 0, sizeof(info));
+    info.port = CONTEXT_PORT_NO_LISTEN;
+    info.protocols = protocols;
+    info.options = 0;
+    info.extensions = options.deflate ? extensions : nullptr;
+
+    struct lws_context *context = lws_create_context(&info);
+    if (!context) {
+        std::cerr << "Failed to create lws context" << std::endl;
+        return false;
+    }
+
+    struct lws_client_connect_info ccinfo;
+    memset(&ccinfo, 0, sizeof(ccinfo));
+    ccinfo.context = context;
+    ccinfo.address = bench.host.c_str();
+    ccinfo.port = bench.port;
+    ccinfo.path = bench.path.c_str();
+    ccinfo.host = bench.host.c_str();
+    ccinfo.origin = bench.host.c_str();
+    ccinfo.protocol = protocols[0].name;
+    ccinfo.ssl_connection = 0;
+
+    if (!lws_client_connect_via_info(&ccinfo)) {
+        std::cerr << "Client connection failed" << std::endl;
+        lws_context_destroy(context);
+        return false;
+    }
+
+    auto connectDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!g_state.connected && !g_state.closed && std::chrono::steady_clock::now() < connectDeadline)
+        lws_service(context, 0);
+    if (!g_state.connected) {
+        std::cerr << "Could not connect to ws://" << bench.host << ":" << bench.port << bench.path << std::endl;
+        lws_context_destroy(context);
+        return false;
+    }
+    if (options.deflate && !g_state.deflateNegotiated) {
+        std::cerr << "The server did not accept permessage-deflate; start feed_simulator with --deflate on"
+                  << std::endl;
+        lws_context_destroy(context);
+        return false;
+    }
+
+    for (auto rate : bench.rates) {
+        g_state.control = "{\"rate\":" + std::to_string(rate) + "}";
+        lws_callback_on_writable(g_state.wsi);
+        service_for(context, std::chrono::seconds(1));
+        if (g_state.controlFailed) {
+            std::cerr << "Could not send the rate control message" << std::endl;
+            lws_context_destroy(context);
+            return false;
+        }
+
+        auto messages = g_state.messages;
+        auto ticks = g_state.ticks;
+        auto payload = g_state.payloadBytes;
+        auto wire = wire_bytes_received(g_state.wsi);
+        auto cpu = process_cpu_seconds();
+        auto start = std::chrono::steady_clock::now();
+
+        service_for(context, std::chrono::seconds(bench.seconds));
+        if (g_state.closed) {
+            std::cerr << "Connection closed during measurement" << std::endl;
+            break;
+        }
+
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        auto dMessages = static_cast<double>(g_state.messages - messages);
+        auto tickRate = static_cast<double>(g_state.ticks - ticks) / elapsed;
+        auto dPayload = static_cast<double>(g_state.payloadBytes - payload);
+        auto dWire = static_cast<double>(wire_bytes_received(g_state.wsi) - wire);
+        auto dCpu = process_cpu_seconds() - cpu;
+
+        auto offRate = tickRate * RateTolerance < rate || tickRate > rate * RateTolerance;
+        rateMismatch |= offRate;
+
+        std::printf("%-10s %12.0f %12.0f %12.0f %14.1f %14.1f %8.2f %12.2f%s\n", label, rate, tickRate,
+                    dMessages / elapsed, dPayload / elapsed / 1e3, dWire / elapsed / 1e3,
+                    dWire > 0 ? dPayload / dWire : 0.0, dMessages > 0 ? dCpu / dMessages * 1e6 : 0.0,
+                    offRate ? " *" : "");
+        std::fflush(stdout);
+    }
+
+    lws_context_destroy(context);
+    return true;
+}
+
+template <typename T> static bool parse_number(std::string_view arg, std::string_view value, T &out) {
+    auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), out);
+    if (ec != std::errc() || ptr != value.data() + value.size()) {
+        std::cerr << "Invalid value '" << value << "' for " << arg << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static bool parse_options(int argc, char **argv, BenchOptions &bench) {
+    for (int i = 1; i < argc; ++i) {
+        auto arg = std::string_view(argv[i]);
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return false;
+        }
+        auto value = std::string(argv[++i]);
+        if (arg == "--host") {
+            bench.host = value;
+        } else if (arg == "--port") {
+            if (!parse_number(arg, value, bench.port))
+                return false;
+        } else if (arg == "--path") {
+            bench.path = value;
+        } else if (arg == "--seconds") {
+            if (!parse_number(arg, value, bench.seconds))
+                return false;
+            bench.seconds = std::max(bench.seconds, 1);
+        } else if (arg == "--rates") {
+            bench.rates.clear();
+            auto stream = std::istringstream(value);
+            for (std::string text; std::getline(stream, text, ',');) {
+                double rate = 0.0;
+                if (!parse_number(arg, text, rate))
+                    return false;
+                bench.rates.push_back(rate);
+            }
+        } else if (arg == "--options") {
+            if (!ParseWebSocketOptions(value, bench.compressed)) {
+                std::cerr << "Invalid WebSocket options '" << value << "'" << std::endl;
+                return false;
+            }
+            bench.compressed.deflate = true;
+        } else {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    auto bench = BenchOptions{};
+    if (!parse_options(argc, argv, bench))
+        return 1;
+
+    lws_set_log_level(LLL_ERR | LLL_WARN, nullptr);
+
+    std::cout << "Compressed run offers: " << DeflateExtensionOffer(bench.compressed) << std::endl;
+    std::printf("%-10s %12s %12s %12s %14s %14s %8s %12s\n", "mode", "tick rate", "ticks/s", "msg/s",
+                "payload KB/s", "wire KB/s", "ratio", "cpu us/msg");
+
+    bool rateMismatch = false;
+    if (!run_config("plain", WebSocketOptions{}, bench, rateMismatch))
+        return 1;
+    if (!run_config("deflate", bench.compressed, bench, rateMismatch))
+        return 1;
+    if (rateMismatch)
+        std::cout << "* measured tick rate is off the requested rate by more than " << RateTolerance
+                  << "x: feed_simulator ignores {\"rate\":N} without --allow-rate-control, and drops ticks when the"
+                     " client falls behind"
+                  << std::endl;
+    return 0;
+}
@@ -0,0 +1,551 @@
+// Native WebSocket feed simulator: stand-in for a market data feed when load/soak testing the RTD WebSocket path.
+//
+//   feed_simulator [--port 8080] [--symbols 4] [--rate 4] [--profile walk|burst] [--mode json|batch|subscribe]
+//                  [--batch-size N] [--queue-limit 4096] [--burst-factor 20] [--burst-ms 200]
+//                  [--burst-period-ms 2000] [--report-ms 1000] [--duration 0] [--seed 1] [--deflate off|on]
+//                  [--allow-rate-control]
+//
+// Ticks are random-walk prices spread over the symbol set at --rate ticks per second (the burst profile multiplies
+// the rate by --burst-factor for --burst-ms out of every --burst-period-ms). Messages use the same shape as the
+// original Node test server plus a source timestamp in Unix epoch microseconds:
+// {"topic":"BTC","value":45000.1234,"ts":1735689600000000}. The batch mode sends JSON arrays of up to
+// --batch-size ticks. The subscribe mode sends only symbols a client asked for with {"subscribe":["BTC","SYM00004"]}
+// ("*" selects everything; "unsubscribe" removes). Each client has a bounded send queue; when a client cannot keep
+// up the oldest queued messages are dropped and reported as backpressure. With --allow-rate-control a client can
+// change the base rate for everyone with {"rate":100000}; the starting rate is restored when that client
+// disconnects. --deflate on accepts permessage-deflate offers, so clients that ask for it get compressed frames.
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <initializer_list>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <libwebsockets.h>
+
+enum class FeedMode { Json, Batch, Subscribe };
+enum class RateProfile { Walk, Burst };
+
+struct SimulatorOptions {
+    int port = 8080;
+    std::size_t symbols = 4;
+    double rate = 4.0;
+    RateProfile profile = RateProfile::Walk;
+    FeedMode mode = FeedMode::Json;
+    std::size_t batchSize = 0;
+    std::size_t queueLimit = 4096;
+    double burstFactor = 20.0;
+    int burstMs = 200;
+    int burstPeriodMs = 2000;
+    int reportMs = 1000;
+    int durationSec = 0;
+    std::uint64_t seed = 1;
+    bool deflate = false;
+    bool allowRateControl = false;
+};
+
+struct Symbol {
+    std::string name;
+    double price;
+};
+
+struct Tick {
+    std::uint32_t symbol;
+    double price;
+    std::int64_t ts;
+};
+
+struct Client {
+    int id = 0;
+    struct lws *wsi = nullptr;
+
+    std::mutex mutex;
+    std::deque<std::string> queue;
+    std::string batch;
+    std::size_t batchTicks = 0;
+    std::vector<char> subscribed;
+
+    std::vector<unsigned char> sendBuffer;
+
+    std::atomic<std::uint64_t> queuedTicks{0};
+    std::atomic<std::uint64_t> sentMessages{0};
+    std::atomic<std::uint64_t> sentBytes{0};
+    std::atomic<std::uint64_t> droppedMessages{0};
+    std::atomic<std::uint64_t> chokedEvents{0};
+
+    // Reporter-side snapshot of the counters above
+    std::uint64_t lastQueuedTicks = 0;
+    std::uint64_t lastSentMessages = 0;
+    std::uint64_t lastSentBytes = 0;
+};
+
+static std::atomic<bool> g_done{false};
+static SimulatorOptions g_options;
+static std::vector<Symbol> g_symbols;
+static std::unordered_map<std::string, std::uint32_t> g_symbolIndex;
+static std::mutex g_clientsMutex;
+static std::map<struct lws *, std::shared_ptr<Client>> g_clients;
+static int g_nextClientId = 1;
+static const struct lws_protocols *g_protocol = nullptr;
+static std::atomic<double> g_rate{0.0};
+static std::atomic<int> g_rateOwner{0}; // client that last set g_rate, 0 for none
+
+static void on_signal(int) { g_done = true; }
+
+static std::vector<std::shared_ptr<Client>> snapshot_clients() {
+    std::lock_guard lock(g_clientsMutex);
+    std::vector<std::shared_ptr<Client>> clients;
+    clients.reserve(g_clients.size());
+    for (auto &[wsi, client] : g_clients)
+        clients.push_back(client);
+    return clients;
+}
+
+// Caller holds client.mutex
+static void enqueue_message(Client &client, std::string message) {
+    if (client.queue.size() >= g_options.queueLimit) {
+        client.queue.pop_front();
+        client.droppedMessages.fetch_add(1, std::memory_order_relaxed);
+    }
+    client.queue.push_back(std::move(message));
+}
+
+// Caller holds client.mutex
+static void flush_batch(Client &client) {
+    if (client.batchTicks == 0)
+        return;
+    if (g_options.batchSize > 1)
+        client.batch.push_back(']');
+    enqueue_message(client, std::move(client.batch));
+    client.batch = std::string();
+    client.batchTicks = 0;
+}
+
+// Caller holds client.mutex
+static void append_tick(Client &client, const Tick &tick) {
+    if (g_options.batchSize > 1)
+        client.batch.push_back(client.batchTicks == 0 ? '[' : ',');
+
+    char value[32];
+    auto [end, ec] = std::to_chars(value, value + sizeof(value), tick.price, std::chars_format::fixed, 4);
+    client.batch += "{\"topic\":\"";
+    client.batch += g_symbols[tick.symbol].name;
+    client.batch += "\",\"value\":";
+    client.batch.append(value, end);
+    client.batch += ",\"ts\":";
+    auto [tsEnd, tsEc] = std::to_chars(value, value + sizeof(value), tick.ts);
+    client.batch.append(value, tsEnd);
+    client.batch.push_back('}');
+
+    client.queuedTicks.fetch_add(1, std::memory_order_relaxed);
+    if (++client.batchTicks >= std::max<std::size_t>(g_options.batchSize, 1))
+        flush_batch(client);
+}
+
+// Applies {"rate":N} (with --allow-rate-control) in any mode and {"subscribe":[...]} / {"unsubscribe":[...]} in
+// subscribe mode.
+static void handle_client_message(Client &client, std::string_view message) {
+    constexpr auto rateKey = std::string_view("\"rate\":");
+    if (auto pos = message.find(rateKey); pos != std::string_view::npos) {
+        if (!g_options.allowRateControl) {
+            std::cout << "Client " << client.id << " rate change ignored (no --allow-rate-control)" << std::endl;
+            return;
+        }
+        double rate = 0.0;
+        auto first = message.data() + pos + rateKey.size();
+        if (std::from_chars(first, message.data() + message.size(), rate).ec == std::errc() && rate >= 0.0) {
+            g_rate = rate;
+            g_rateOwner = client.id;
+            std::cout << "Client " << client.id << " set rate to " << rate << " ticks/s" << std::endl;
+        }
+        return;
+    }
+
+    if (g_options.mode != FeedMode::Subscribe)
+        return;
+
+    bool subscribe = message.find("\"subscribe\"") != std::string_view::npos;
+    bool unsubscribe = message.find("\"unsubscribe\"") != std::string_view::npos;
+    if (!subscribe && !unsubscribe)
+        return;
+
+    auto list = message.find('[');
+    if (list == std::string_view::npos)
+        return;
+
+    std::lock_guard lock(client.mutex);
+    auto pos = list;
+    while (true) {
+        auto open = message.find('"', pos + 1);
+        if (open == std::string_view::npos)
+            break;
+        auto close = message.find('"', open + 1);
+        if (close == std::string_view::npos)
+            break;
+        auto name = std::string(message.substr(open + 1, close - open - 1));
+        if (name == "*") {
+            std::fill(client.subscribed.begin(), client.subscribed.end(), subscribe ? 1 : 0);
+        } else if (auto it = g_symbolIndex.find(name); it != g_symbolIndex.end()) {
+            client.subscribed[it->second] = subscribe ? 1 : 0;
+        }
+        pos = close;
+    }
+}
+
+static int ws_callback(struct lws *wsi, enum lws_callback_reasons reason, void *user, void *in, size_t len) {
+    switch (reason) {
+    case LWS_CALLBACK_ESTABLISHED: {
+        auto client = std::make_shared<Client>();
+        client->wsi = wsi;
+        client->subscribed.assign(g_symbols.size(), g_options.mode == FeedMode::Subscribe ? 0 : 1);
+        {
+            std::lock_guard lock(g_clientsMutex);
+            client->id = g_nextClientId++;
+            g_clients[wsi] = client;
+        }
+        {
+            std::lock_guard lock(client->mutex);
+            enqueue_message(*client, "{\"message\":\"Connected to RTD feed simulator\",\"symbols\":" +
+                                         std::to_string(g_symbols.size()) + "}");
+        }
+        std::cout << "Client " << client->id << " connected" << std::endl;
+        lws_callback_on_writable(wsi);
+        break;
+    }
+    case LWS_CALLBACK_RECEIVE: {
+        std::shared_ptr<Client> client;
+        {
+            std::lock_guard lock(g_clientsMutex);
+            if (auto it = g_clients.find(wsi); it != g_clients.end())
+                client = it->second;
+        }
+        if (client)
+            handle_client_message(*client, std::string_view(static_cast<const char *>(in), len));
+        break;
+    }
+    case LWS_CALLBACK_SERVER_WRITEABLE: {
+        std::shared_ptr<Client> client;
+        {
+            std::lock_guard lock(g_clientsMutex);
+            if (auto it = g_clients.find(wsi); it != g_clients.end())
+                client = it->second;
+        }
+        if (!client)
+            break;
+
+        // Bounded number of frames per callback keeps clients fair on the single service thread
+        bool more = false;
+        for (int n = 0; n < 64; ++n) {
+            std::string message;
+            {
+                std::lock_guard lock(client->mutex);
+                if (client->queue.empty())
+                    break;
+                message = std::move(client->queue.front());
+                client->queue.pop_front();
+                more = !client->queue.empty();
+            }
+
+            client->sendBuffer.resize(LWS_PRE + message.size());
+            std::memcpy(client->sendBuffer.data() + LWS_PRE, message.data(), message.size());
+            int written = lws_write(wsi, client->sendBuffer.data() + LWS_PRE, message.size(), LWS_WRITE_TEXT);
+            if (written < static_cast<int>(message.size())) {
+                std::cerr << "Write failed for client " << client->id << std::endl;
+                return -1;
+            }
+            client->sentMessages.fetch_add(1, std::memory_order_relaxed);
+            client->sentBytes.fetch_add(message.size(), std::memory_order_relaxed);
+
+            if (more && lws_send_pipe_choked(wsi)) {
+                client->chokedEvents.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+        }
+        if (more)
+            lws_callback_on_writable(wsi);
+        break;
+    }
+    case LWS_CALLBACK_CLOSED: {
+        std::lock_guard lock(g_clientsMutex);
+        if (auto it = g_clients.find(wsi); it != g_clients.end()) {
+            auto id = it->second->id;
+            std::cout << "Client " << id << " disconnected" << std::endl;
+            if (g_rateOwner.compare_exchange_strong(id, 0)) {
+                g_rate = g_options.rate;
+                std::cout << "Rate restored to " << g_options.rate << " ticks/s" << std::endl;
+            }
+            g_clients.erase(it);
+        }
+        break;
+    }
+    case LWS_CALLBACK_EVENT_WAIT_CANCELLED:
+        // Woken by the generator thread: new messages are queued
+        lws_callback_on_writable_all_protocol(lws_get_context(wsi), g_protocol);
+        break;
+    default:
+        break;
+    }
+    return 0;
+}
+
+static struct lws_protocols protocols[] = {{"rtd-protocol", ws_callback, 0, 65536}, {nullptr, nullptr, 0, 0}};
+
+static double current_rate(std::chrono::steady_clock::duration elapsed) {
+    auto rate = g_rate.load(std::memory_order_relaxed);
+    if (g_options.profile != RateProfile::Burst || g_options.burstPeriodMs <= 0)
+        return rate;
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+    return (ms % g_options.burstPeriodMs) < g_options.burstMs ? rate * g_options.burstFactor : rate;
+}
+
+static void run_generator(struct lws_context *context) {
+    constexpr std::size_t maxTicksPerChunk = 1 << 16;
+
+    std::mt19937_64 rng(g_options.seed);
+    std::uniform_int_distribution<std::uint32_t> pick(0, static_cast<std::uint32_t>(g_symbols.size() - 1));
+    std::normal_distribution<double> shock(0.0, 1.0);
+    std::vector<Tick> ticks;
+    ticks.reserve(maxTicksPerChunk);
+
+    auto start = std::chrono::steady_clock::now();
+    auto last = start;
+    double credit = 0.0;
+    while (!g_done) {
+        // Credit is capped at one chunk, so a generator that fell behind resumes the configured profile instead of
+        // replaying the backlog flat out
+        auto now = std::chrono::steady_clock::now();
+        credit += current_rate(now - start) * std::chrono::duration<double>(now - last).count();
+        credit = std::min(credit, static_cast<double>(maxTicksPerChunk));
+        last = now;
+
+        auto count = std::min(static_cast<std::size_t>(credit), maxTicksPerChunk);
+        credit -= static_cast<double>(count);
+
+        auto ts = std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::system_clock::now().time_since_epoch())
+                      .count();
+        ticks.clear();
+        for (std::size_t i = 0; i < count; ++i) {
+            auto index = pick(rng);
+            auto &symbol = g_symbols[index];
+            symbol.price = std::max(symbol.price * (1.0 + 0.0005 * shock(rng)), 0.0001);
+            ticks.push_back(Tick{.symbol = index, .price = symbol.price, .ts = ts});
+        }
+
+        if (!ticks.empty()) {
+            for (auto &client : snapshot_clients()) {
+                std::lock_guard lock(client->mutex);
+                for (const auto &tick : ticks) {
+                    if (client->subscribed[tick.symbol])
+                        append_tick(*client, tick);
+                }
+                flush_batch(*client);
+            }
+            lws_cancel_service(context);
+        }
+
+        if (count < maxTicksPerChunk)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+static void report(double seconds) {
+    for (auto &client : snapshot_clients()) {
+        auto queued = client->queuedTicks.load(std::memory_order_relaxed);
+        auto messages = client->sentMessages.load(std::memory_order_relaxed);
+        auto bytes = client->sentBytes.load(std::memory_order_relaxed);
+        std::size_t depth = 0;
+        {
+            std::lock_guard lock(client->mutex);
+            depth = client->queue.size();
+        }
+
+        std::printf("client %d: %10.0f ticks/s %10.0f msg/s %8.2f MB/s queue %zu/%zu dropped %llu choked %llu\n",
+                    client->id, (queued - client->lastQueuedTicks) / seconds,
+                    (messages - client->lastSentMessages) / seconds, (bytes - client->lastSentBytes) / seconds / 1e6,
+                    depth, g_options.queueLimit,
+                    static_cast<unsigned long long>(client->droppedMessages.load(std::memory_order_relaxed)),
+                    static_cast<unsigned long long>(client->chokedEvents.load(std::memory_order_relaxed)));
+
+        client->lastQueuedTicks = queued;
+        client->lastSentMessages = messages;
+        client->lastSentBytes = bytes;
+    }
+    std::fflush(stdout);
+}
+
+template <typename T> static bool parse_number(std::string_view arg, std::string_view value, T &out) {
+    auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), out);
+    if (ec != std::errc() || ptr != value.data() + value.size()) {
+        std::cerr << "Invalid value '" << value << "' for " << arg << std::endl;
+        return false;
+    }
+    return true;
+}
+
+template <typename T>
+static bool parse_choice(std::string_view arg, std::string_view value,
+                         std::initializer_list<std::pair<std::string_view, T>> choices, T &out) {
+    for (const auto &[name, choice] : choices) {
+        if (value == name) {
+            out = choice;
+            return true;
+        }
+    }
+    std::cerr << "Invalid value '" << value << "' for " << arg << std::endl;
+    return false;
+}
+
+static bool parse_options(int argc, char **argv) {
+    for (int i = 1; i < argc; ++i) {
+        auto arg = std::string_view(argv[i]);
+        if (arg == "--allow-rate-control") {
+            g_options.allowRateControl = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return false;
+        }
+        auto value = std::string_view(argv[++i]);
+        bool ok = true;
+        if (arg == "--port")
+            ok = parse_number(arg, value, g_options.port);
+        else if (arg == "--symbols")
+            ok = parse_number(arg, value, g_options.symbols);
+        else if (arg == "--rate")
+            ok = parse_number(arg, value, g_options.rate);
+        else if (arg == "--profile")
+            ok = parse_choice(arg, value, {{"walk", RateProfile::Walk}, {"burst", RateProfile::Burst}},
+                              g_options.profile);
+        else if (arg == "--mode")
+            ok = parse_choice(
+                arg, value, {{"json", FeedMode::Json}, {"batch", FeedMode::Batch}, {"subscribe", FeedMode::Subscribe}},
+                g_options.mode);
+        else if (arg == "--batch-size")
+            ok = parse_number(arg, value, g_options.batchSize);
+        else if (arg == "--queue-limit")
+            ok = parse_number(arg, value, g_options.queueLimit);
+        else if (arg == "--burst-factor")
+            ok = parse_number(arg, value, g_options.burstFactor);
+        else if (arg == "--burst-ms")
+            ok = parse_number(arg, value, g_options.burstMs);
+        else if (arg == "--burst-period-ms")
+            ok = parse_number(arg, value, g_options.burstPeriodMs);
+        else if (arg == "--report-ms")
+            ok = parse_number(arg, value, g_options.reportMs);
+        else if (arg == "--duration")
+            ok = parse_number(arg, value, g_options.durationSec);
+        else if (arg == "--seed")
+            ok = parse_number(arg, value, g_options.seed);
+        else if (arg == "--deflate")
+            ok = parse_choice(arg, value, {{"off", false}, {"on", true}}, g_options.deflate);
+        else {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return false;
+        }
+        if (!ok)
+            return false;
+    }
+
+    g_options.symbols = std::max<std::size_t>(g_options.symbols, 1);
+    g_options.queueLimit = std::max<std::size_t>(g_options.queueLimit, 1);
+    g_options.reportMs = std::max(g_options.reportMs, 1);
+    if (g_options.mode == FeedMode::Json)
+        g_options.batchSize = 1;
+    else if (g_options.batchSize == 0)
+        g_options.batchSize = g_options.mode == FeedMode::Batch ? 256 : 1;
+    return true;
+}
+
+static void build_symbols() {
+    // The first four match the original Node test server so existing workbooks keep working
+    static const Symbol named[] = {{"BTC", 45000.0}, {"EURUSD", 1.09}, {"GOLD", 2050.0}, {"AAPL", 180.0}};
+    g_symbols.clear();
+    for (std::size_t i = 0; i < g_options.symbols; ++i) {
+        if (i < std::size(named)) {
+            g_symbols.push_back(named[i]);
+        } else {
+            char name[16];
+            std::snprintf(name, sizeof(name), "SYM%05zu", i);
+            g_symbols.push_back(Symbol{.name = name, .price = 100.0});
+        }
+        g_symbolIndex[g_symbols.back().name] = static_cast<std::uint32_t>(i);
+    }
+}
+
+int main(int argc, char **argv) {
+    if (!parse_options(argc, argv))
+        return 1;
+    build_symbols();
+
+    std::signal(SIGINT, on_signal);
+    lws_set_log_level(LLL_ERR | LLL_WARN, nullptr);
+
+    struct lws_context_creation_info info;
+    memset(&info, 0, sizeof(info));
+    info.port = g_options.port;
+    info.protocols = protocols;
+    info.options = 0;
+    g_protocol = &protocols[0];
+    g_rate = g_options.rate;
+
+    static const struct lws_extension extensions[] = {
+        {"permessage-deflate", lws_extension_callback_pm_deflate, "permessage-deflate; client_max_window_bits"},
+        {nullptr, nullptr, nullptr}};
+    if (g_options.deflate)
+        info.extensions = extensions;
+
+    struct lws_context *context = lws_create_context(&info);
+    if (!context) {
+        std::cerr << "Failed to create lws context" << std::endl;
+        return 1;
+    }
+
+    static const char *modeNames[] = {"json", "batch", "subscribe"};
+    std::cout << "Feed simulator on ws://localhost:" << g_options.port << " - " << g_symbols.size() << " symbols, "
+              << g_options.rate << " ticks/s, " << (g_options.profile == RateProfile::Burst ? "burst" : "walk")
+              << " profile, " << modeNames[static_cast<int>(g_options.mode)] << " mode, batch "
+              << g_options.batchSize << ", permessage-deflate " << (g_options.deflate ? "on" : "off")
+              << ", rate control " << (g_options.allowRateControl ? "on" : "off") << std::endl;
+    std::cout << "Test in Excel with: =RTD(\"mycompany.rtdtickcpp\",, \"ws://localhost:" << g_options.port
+              << "\", \"BTC\")" << std::endl;
+
+    std::thread generator(run_generator, context);
+
+    auto start = std::chrono::steady_clock::now();
+    auto lastReport = start;
+    while (!g_done) {
+        lws_service(context, 0);
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastReport >= std::chrono::milliseconds(g_options.reportMs)) {
+            report(std::chrono::duration<double>(now - lastReport).count());
+            lastReport = now;
+        }
+        if (g_options.durationSec > 0 && now - start >= std::chrono::seconds(g_options.durationSec)) {
+            std::cout << "Duration reached, exiting" << std::endl;
+            g_done = true;
+        }
+    }
+
+    generator.join();
+    lws_context_destroy(context);
+    return 0;
+}
@@ -0,0 +1,134 @@
+// Checks LatencyHistogram bucket math and the percentiles LatencyTracer writes for each interval: known latencies
+// are recorded, snapshots are flushed, and p50/p99/max and per-interval counts are read back from the CSV.
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "LatencyTrace.h"
+
+static int g_failures = 0;
+
+static void Check(bool condition, const std::string &what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        ++g_failures;
+    }
+}
+
+// Log-linear buckets with 32 sub-buckets resolve a value to within 1/32 of itself
+static bool Near(double actual, double expected) { return std::abs(actual - expected) <= expected / 32.0 + 1.0; }
+
+static void TestBuckets() {
+    for (std::int64_t ns : {0LL, 1LL, 31LL, 32LL, 33LL, 63LL, 64LL, 1000LL, 123456LL, 1'000'000'000LL,
+                            1'000'000'000'000LL}) {
+        auto value = LatencyHistogram::BucketValue(LatencyHistogram::BucketIndex(ns));
+        Check(Near(static_cast<double>(value), static_cast<double>(ns)),
+              "bucket of " + std::to_string(ns) + " ns maps back to " + std::to_string(value));
+    }
+    for (std::int64_t ns = 0; ns < 1'000'000; ns += 7) {
+        if (LatencyHistogram::BucketIndex(ns + 7) < LatencyHistogram::BucketIndex(ns)) {
+            Check(false, "bucket index is monotonic at " + std::to_string(ns));
+            break;
+        }
+    }
+    Check(LatencyHistogram::BucketIndex(-5) == 0, "negative latencies land in the first bucket");
+    Check(LatencyHistogram::BucketIndex(std::numeric_limits<std::int64_t>::max()) == LatencyHistogram::BucketCount - 1,
+          "latencies past the range land in the last bucket");
+}
+
+struct Row {
+    std::string source;
+    std::string stage;
+    std::uint64_t count = 0;
+    std::vector<double> percentilesUs; // p50, p90, p99, p999, max
+};
+
+static std::vector<Row> ReadRows(const std::filesystem::path &path) {
+    std::vector<Row> rows;
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line); // header
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        std::string field;
+        Row row;
+        std::getline(fields, field, ','); // time_ms
+        std::getline(fields, row.source, ',');
+        std::getline(fields, row.stage, ',');
+        std::getline(fields, field, ',');
+        row.count = std::stoull(field);
+        while (std::getline(fields, field, ','))
+            row.percentilesUs.push_back(std::stod(field));
+        rows.push_back(row);
+    }
+    return rows;
+}
+
+// Records a parse-stage latency; the other stages stay unstamped and record nothing
+static void RecordParse(LatencyTracer &tracer, std::int64_t latencyNs) {
+    constexpr std::int64_t receiveNs = 1'000'000'000;
+    tracer.Record(0, UpdateTrace{.receiveNs = receiveNs, .parseNs = receiveNs + latencyNs}, 0);
+}
+
+static void TestTracerPercentiles() {
+    auto path = std::filesystem::temp_directory_path() / "latency_histogram_test.csv";
+    std::filesystem::remove(path);
+
+    LatencyTracer tracer;
+    tracer.AddSource("test");
+    // Long interval: only Flush() and Stop() write snapshots
+    Check(tracer.Start(std::chrono::hours(1), path.string()), "tracer starts");
+
+    // 1..1000 us
+    for (int us = 1; us <= 1000; ++us)
+        RecordParse(tracer, us * 1000LL);
+    tracer.Flush();
+
+    // The next interval reports only its own samples
+    for (int i = 0; i < 100; ++i)
+        RecordParse(tracer, 5'000'000);
+    tracer.Flush();
+
+    // Nothing recorded since the last flush, so the final snapshot adds no row
+    tracer.Stop();
+
+    auto rows = ReadRows(path);
+    std::filesystem::remove(path);
+    Check(rows.size() == 2, "one row per non-empty interval, got " + std::to_string(rows.size()));
+    if (rows.size() != 2)
+        return;
+
+    const auto &first = rows[0];
+    Check(first.source == "test" && first.stage == "parse", "row names the source and stage");
+    Check(first.count == 1000, "first interval counts its 1000 samples");
+    Check(first.percentilesUs.size() == 5, "row has five percentiles");
+    if (first.percentilesUs.size() == 5) {
+        Check(Near(first.percentilesUs[0], 500.0), "p50 of 1..1000 us is ~500 us");
+        Check(Near(first.percentilesUs[2], 990.0), "p99 of 1..1000 us is ~990 us");
+        Check(Near(first.percentilesUs[4], 1000.0), "max of 1..1000 us is ~1000 us");
+    }
+
+    const auto &second = rows[1];
+    Check(second.count == 100, "second interval counts only its own samples");
+    if (second.percentilesUs.size() == 5) {
+        Check(Near(second.percentilesUs[0], 5000.0), "second interval p50 is ~5000 us");
+        Check(Near(second.percentilesUs[4], 5000.0), "second interval max is ~5000 us");
+    }
+}
+
+int main() {
+    TestBuckets();
+    TestTracerPercentiles();
+
+    if (g_failures != 0)
+        return 1;
+    std::cout << "PASSED" << std::endl;
+    return 0;
+}
@@ -0,0 +1,81 @@
+// Checks the second topic string handling of synthetic topics: plain tags pass through as tags, specs parse with
+// per-model defaults, and malformed, non-finite or negative settings are rejected.
+#include <cmath>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "SyntheticMarket.h"
+
+static int g_failures = 0;
+
+static void Check(bool condition, const std::string &what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        ++g_failures;
+    }
+}
+
+static void TestTags() {
+    for (std::string_view tag : {"", "A1", "Sheet1!B2", "prices", "gbm"})
+        Check(!IsPriceModelSpec(tag), "'" + std::string(tag) + "' is a plain tag");
+    for (std::string_view spec : {"model=walk", "start=100", "model=gbm;vol=0.002"})
+        Check(IsPriceModelSpec(spec), "'" + std::string(spec) + "' is a model spec");
+}
+
+static void TestDefaults() {
+    auto params = PriceModelParams{};
+    Check(ParsePriceModelParams("", params) && params.model == PriceModel::Uniform && params.start == 100.0 &&
+              params.drift == 0.0 && params.vol == 0.0 && params.tick == 0.0,
+          "an empty spec selects the uniform model");
+
+    Check(ParsePriceModelParams("model=walk", params) && params.model == PriceModel::RandomWalk && params.vol == 0.1,
+          "the random walk defaults to vol 0.1");
+    Check(ParsePriceModelParams("model=gbm", params) && params.model == PriceModel::Geometric && params.vol == 0.001,
+          "the geometric model defaults to vol 0.001");
+
+    Check(ParsePriceModelParams("model=gbm;start=250,drift=-0.0001;vol=0.002;tick=0.01", params) &&
+              params.model == PriceModel::Geometric && params.start == 250.0 && params.drift == -0.0001 &&
+              params.vol == 0.002 && params.tick == 0.01,
+          "every key parses, with ';' or ',' between items");
+    Check(ParsePriceModelParams("model=walk;start=0;vol=0", params) && params.start == 0.0 && params.vol == 0.0,
+          "zero start and vol are accepted");
+}
+
+static void TestRejected() {
+    for (std::string_view spec : {"model=brownian", "model=walk;colour=red", "model=walk;start", "start=abc",
+                                  "start=100x", "start=", "model=walk;start=nan;tick=0.01", "start=-nan",
+                                  "model=gbm;drift=inf", "vol=-inf", "tick=infinity", "start=1e400",
+                                  "start=-50", "vol=-0.1", "tick=-0.01"}) {
+        auto params = PriceModelParams{};
+        Check(!ParsePriceModelParams(spec, params), "'" + std::string(spec) + "' is rejected");
+    }
+}
+
+// Prices of every accepted model stay finite
+static void TestFinitePrices() {
+    SyntheticMarket market(7);
+    for (std::string_view spec : {"", "model=walk;start=0;tick=0.01", "model=gbm;start=50;drift=0.001;vol=0.01"}) {
+        auto params = PriceModelParams{};
+        if (ParsePriceModelParams(spec, params))
+            market.Add(params);
+    }
+    Check(market.Size() == 3, "all three specs parse");
+    for (int tick = 0; tick < 100; ++tick)
+        market.Step();
+    for (std::size_t slot = 0; slot < market.Size(); ++slot)
+        Check(std::isfinite(market.Price(slot)), "slot " + std::to_string(slot) + " has a finite price");
+}
+
+int main() {
+    TestTags();
+    TestDefaults();
+    TestRejected();
+    TestFinitePrices();
+
+    if (g_failures != 0)
+        return 1;
+    std::cout << "PASSED" << std::endl;
+    return 0;
+}
@@ -0,0 +1,145 @@
+// Behaviour checks for UpdateScheduler: class order, aging, latest-value coalescing, sampled stamps and stale queue
+// entries after a topic is removed and added again, or added again while still pending.
+#include <initializer_list>
+#include <iostream>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+#include "UpdateScheduler.h"
+
+static int g_failures = 0;
+
+static void Check(bool condition, const char *what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        ++g_failures;
+    }
+}
+
+static void Post(UpdateScheduler &scheduler, std::initializer_list<std::pair<long, double>> values) {
+    auto updates = TopicUpdateBatch(std::pmr::get_default_resource());
+    for (auto [topicId, value] : values)
+        updates.push_back(TopicUpdate{.topicId = topicId, .value = value});
+    scheduler.Post(updates);
+}
+
+static std::vector<long> Drain(UpdateScheduler &scheduler) {
+    auto batch = TopicUpdateBatch(std::pmr::get_default_resource());
+    scheduler.Drain(batch);
+    auto topicIds = std::vector<long>();
+    for (const auto &update : batch)
+        topicIds.push_back(update.topicId);
+    return topicIds;
+}
+
+static void TestClassOrder() {
+    UpdateScheduler scheduler(2, 0);
+    scheduler.AddTopic(1, TopicPriority::Low);
+    scheduler.AddTopic(2, TopicPriority::Normal);
+    scheduler.AddTopic(3, TopicPriority::High);
+    Post(scheduler, {{1, 1.0}, {2, 2.0}, {3, 3.0}});
+
+    Check(Drain(scheduler) == std::vector<long>{3, 2}, "high and normal drain first under the cap");
+    Check(Drain(scheduler) == std::vector<long>{1}, "low drains once the higher classes are empty");
+    Check(!scheduler.HasPending(), "nothing pending after the backlog drains");
+}
+
+static void TestAging() {
+    constexpr std::uint64_t agingCycles = 3;
+    UpdateScheduler scheduler(1, agingCycles);
+    scheduler.AddTopic(1, TopicPriority::High);
+    scheduler.AddTopic(2, TopicPriority::Low);
+    Post(scheduler, {{2, 2.0}});
+
+    // The high topic always has a fresh value, so without aging the low one would never drain
+    int lowDrainedAt = -1;
+    for (int cycle = 0; cycle < 20 && lowDrainedAt < 0; ++cycle) {
+        Post(scheduler, {{1, static_cast<double>(cycle)}});
+        auto drained = Drain(scheduler);
+        Check(drained.size() == 1, "one update per refresh under a cap of one");
+        if (!drained.empty() && drained.front() == 2)
+            lowDrainedAt = cycle;
+    }
+    Check(lowDrainedAt >= static_cast<int>(agingCycles), "low topic is not promoted before AgingCycles");
+    Check(lowDrainedAt >= 0, "low topic is promoted and eventually drains");
+}
+
+static void TestCoalescing() {
+    UpdateScheduler scheduler(10, 0);
+    scheduler.AddTopic(1, TopicPriority::Normal);
+    Post(scheduler, {{1, 1.0}});
+    Post(scheduler, {{1, 2.0}, {1, 3.0}});
+    Check(scheduler.PendingCount() == 1, "a newer value replaces the pending one");
+
+    auto batch = TopicUpdateBatch(std::pmr::get_default_resource());
+    scheduler.Drain(batch);
+    Check(batch.size() == 1 && batch.front().value == 3.0, "only the latest value drains");
+    Check(Drain(scheduler).empty(), "the replaced value is not queued twice");
+}
+
+static void TestSampledTraces() {
+    UpdateScheduler scheduler(10, 0);
+    scheduler.AddTopic(1, TopicPriority::Normal);
+    scheduler.AddTopic(2, TopicPriority::High);
+
+    auto updates = TopicUpdateBatch(std::pmr::get_default_resource());
+    updates.push_back(TopicUpdate{.topicId = 1, .value = 1.0});
+    updates.push_back(TopicUpdate{.topicId = 2, .value = 2.0});
+    auto samples = SampledTraceBatch(std::pmr::get_default_resource());
+    samples.push_back(SampledTrace{.index = 0, .trace = UpdateTrace{.receiveNs = 42}});
+    scheduler.Post(updates, samples);
+
+    auto batch = TopicUpdateBatch(std::pmr::get_default_resource());
+    auto traces = SampledTraceBatch(std::pmr::get_default_resource());
+    scheduler.Drain(batch, &traces);
+    Check(traces.size() == 1 && batch[traces.front().index].topicId == 1 && traces.front().trace.receiveNs == 42,
+          "sampled stamps follow their update into the drained batch");
+
+    // An unsampled newer value replaces a sampled pending one along with its stamps
+    scheduler.Post(updates, samples);
+    Post(scheduler, {{1, 3.0}});
+    traces.clear();
+    scheduler.Drain(batch, &traces);
+    Check(traces.empty(), "stamps of a replaced value are dropped");
+}
+
+static void TestRemoveAndAddAgain() {
+    UpdateScheduler scheduler(1, 0);
+    scheduler.AddTopic(1, TopicPriority::High);
+    scheduler.AddTopic(2, TopicPriority::Normal);
+    Post(scheduler, {{1, 1.0}});
+
+    // Leaves a stale entry for topic 1 at the front of the high queue
+    scheduler.RemoveTopic(1);
+    Check(!scheduler.HasPending(), "removing a topic drops its pending value");
+    scheduler.AddTopic(1, TopicPriority::Low);
+    Post(scheduler, {{2, 2.0}, {1, 1.5}});
+
+    Check(Drain(scheduler) == std::vector<long>{2}, "re-added topic does not drain early through the stale entry");
+    Check(Drain(scheduler) == std::vector<long>{1}, "re-added topic drains in its new class");
+    Check(Drain(scheduler).empty(), "re-added topic drains once");
+
+    // Adding a connected topic again while it has a value pending
+    Post(scheduler, {{1, 1.75}});
+    scheduler.AddTopic(1, TopicPriority::Normal);
+    Check(!scheduler.HasPending(), "adding a pending topic again drops its pending value");
+    Check(Drain(scheduler).empty(), "the dropped value does not drain");
+    Post(scheduler, {{1, 2.5}});
+    Check(scheduler.PendingCount() == 1, "the re-added topic is counted once");
+    Check(Drain(scheduler) == std::vector<long>{1}, "the re-added topic drains its new value");
+    Check(!scheduler.HasPending(), "nothing pending after the re-added topic drains");
+}
+
+int main() {
+    TestClassOrder();
+    TestAging();
+    TestCoalescing();
+    TestSampledTraces();
+    TestRemoveAndAddAgain();
+
+    if (g_failures != 0)
+        return 1;
+    std::cout << "PASSED" << std::endl;
+    return 0;
+}
@@ -1,21 +1,51 @@
+// Minimal WebSocket client for the feed simulator: prints each message and its feed-to-client latency.
+//
+//   websocket_client [--options "deflate=on;window=12;takeover=off"]
+//
+// --options takes the WebSocketOptions.h syntax; deflate=on offers permessage-deflate to the server.
 #include <atomic>
+#include <charconv>
 #include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <system_error>
 #include <thread>
 
 #include <libwebsockets.h>
 
+#include "UpdateTrace.h"
+#include "WebSocketOptions.h"
+
 static std::atomic<bool> g_done{false};
 
+// Reassembly buffer for fragmented (and, with deflate, inflated) messages; its capacity is reused across messages
+static std::string g_message;
+
 static int ws_callback(struct lws *wsi, enum lws_callback_reasons reason, void *user, void *in, size_t len) {
     switch (reason) {
     case LWS_CALLBACK_CLIENT_ESTABLISHED:
         std::cout << "Connected to server" << std::endl;
         break;
     case LWS_CALLBACK_CLIENT_RECEIVE: {
-        std::string msg(reinterpret_cast<char *>(in), len);
-        std::cout << "Received: " << msg << std::endl;
+        auto receiveNs = TraceNow();
+        g_message.append(static_cast<const char *>(in), len);
+        if (!lws_is_final_fragment(wsi))
+            break;
+        std::cout << "Received: " << g_message << std::endl;
+
+        // Feed-to-client latency from the first "ts" field, when the feed sends one
+        if (auto pos = g_message.find("\"ts\":"); pos != std::string::npos) {
+            std::int64_t ts = 0;
+            auto first = g_message.data() + pos + 5;
+            if (std::from_chars(first, g_message.data() + g_message.size(), ts).ec == std::errc()) {
+                auto latencyNs = receiveNs - FeedTimestampToTrace(ts, receiveNs);
+                std::cout << "Latency: " << latencyNs / 1000.0 << " us" << std::endl;
+            }
+        }
+        g_message.clear();
         break;
     }
     case LWS_CALLBACK_CLIENT_CONNECTION_ERROR:
@@ -39,11 +69,34 @@ int main(int argc, char **argv) {
     int port = 8080;
     const char *path = "/stream";
 
+    auto options = WebSocketOptions{};
+    for (int i = 1; i < argc; ++i) {
+        auto arg = std::string_view(argv[i]);
+        if (arg == "--options" && i + 1 < argc) {
+            auto value = std::string_view(argv[++i]);
+            if (!ParseWebSocketOptions(value, options)) {
+                std::cerr << "Invalid WebSocket options '" << value << "'" << std::endl;
+                return 1;
+            }
+        } else {
+            std::cerr << "Usage: websocket_client [--options \"deflate=on;window=12;takeover=off\"]" << std::endl;
+            return 1;
+        }
+    }
+    g_message.reserve(1 << 16);
+
+    auto offer = DeflateExtensionOffer(options);
+    const struct lws_extension extensions[] = {
+        {"permessage-deflate", lws_extension_callback_pm_deflate, offer.c_str()}, {nullptr, nullptr, nullptr}};
+
     struct lws_context_creation_info info;
     memset(&info, 0, sizeof(info));
     info.port = CONTEXT_PORT_NO_LISTEN;
     info.protocols = protocols;
     info.options = 0;
+    info.extensions = options.deflate ? extensions : nullptr;
+    if (options.deflate)
+        std::cout << "Offering " << offer << std::endl;
 
     struct lws_context *context = lws_create_context(&info);
     if (!context) {